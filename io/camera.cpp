@@ -5,32 +5,68 @@
 #include "hikrobot/hikrobot.hpp"
 #include "mindvision/mindvision.hpp"
 #include "daheng/daheng.hpp"
+#include "replay/replay.hpp"
 #include "tools/yaml.hpp"
 
+using namespace std::chrono_literals;
+
 namespace io
 {
+bool CameraBase::wait_for_restart(
+  const std::atomic<bool> & running, const std::atomic<bool> & quit)
+{
+  std::unique_lock<std::mutex> lock(daemon_mutex_);
+  daemon_condition_.wait(lock, [&] { return !running || quit; });
+  if (quit) return false;
+  return !daemon_condition_.wait_for(lock, 100ms, [&] { return quit.load(); });
+}
+
+void CameraBase::notify_daemon(std::atomic<bool> & flag, bool value)
+{
+  {
+    std::lock_guard<std::mutex> lock(daemon_mutex_);
+    flag = value;
+  }
+  daemon_condition_.notify_all();
+}
+
 Camera::Camera(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
   auto camera_name = tools::read<std::string>(yaml, "camera_name");
+  format_ = tools::read_pixel_format(yaml);
+
+  // 回放Recorder录制的视频，不需要曝光等相机参数
+  if (camera_name == "replay") {
+    auto path = tools::read<std::string>(yaml, "replay_path");
+    auto realtime = yaml["replay_realtime"].IsDefined() ? yaml["replay_realtime"].as<bool>() : true;
+    auto loop = yaml["replay_loop"].IsDefined() ? yaml["replay_loop"].as<bool>() : false;
+    if (format_ != tools::PixelFormat::bgr)
+      throw std::runtime_error("Replay only supports bgr camera_format!");
+    camera_ = std::make_unique<Replay>(path, realtime, loop);
+    return;
+  }
+
   auto exposure_ms = tools::read<double>(yaml, "exposure_ms");
 
   if (camera_name == "mindvision") {
     auto gamma = tools::read<double>(yaml, "gamma");
     auto vid_pid = tools::read<std::string>(yaml, "vid_pid");
+    if (format_ != tools::PixelFormat::bgr)
+      throw std::runtime_error("MindVision only supports bgr camera_format!");
     camera_ = std::make_unique<MindVision>(exposure_ms, gamma, vid_pid);
   }
 
   else if (camera_name == "hikrobot") {
     auto gain = tools::read<double>(yaml, "gain");
     auto vid_pid = tools::read<std::string>(yaml, "vid_pid");
-    camera_ = std::make_unique<HikRobot>(exposure_ms, gain, vid_pid);
+    camera_ = std::make_unique<HikRobot>(exposure_ms, gain, vid_pid, format_);
   }
 
   else if (camera_name == "daheng") {
     auto gain = tools::read<double>(yaml, "gain");
     auto vid_pid = tools::read<std::string>(yaml, "vid_pid");
-    camera_ = std::make_unique<Daheng>(exposure_ms, gain, vid_pid);
+    camera_ = std::make_unique<Daheng>(exposure_ms, gain, vid_pid, format_);
   }
 
   else {
@@ -43,4 +79,8 @@ void Camera::read(cv::Mat & img, std::chrono::steady_clock::time_point & timesta
   camera_->read(img, timestamp);
 }
 
+tools::FramePool::Stats Camera::frame_pool_stats() const { return camera_->frame_pool_stats(); }
+
+tools::ClockModel::Metrics Camera::clock_metrics() const { return camera_->clock_metrics(); }
+
 }  // namespace io
\ No newline at end of file
@@ -1,11 +1,18 @@
 #ifndef IO__CAMERA_HPP
 #define IO__CAMERA_HPP
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <string>
 
+#include "tools/clock_model.hpp"
+#include "tools/frame_pool.hpp"
+#include "tools/pixel_format.hpp"
+
 namespace io
 {
 class CameraBase
@@ -13,6 +20,30 @@ class CameraBase
 public:
   virtual ~CameraBase() = default;
   virtual void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) = 0;
+
+  tools::FramePool::Stats frame_pool_stats() const { return frame_pool_.stats(); }
+
+  // 设备时钟到steady_clock的映射状态
+  tools::ClockModel::Metrics clock_metrics() const { return clock_model_.metrics(); }
+
+protected:
+  // 采集线程从池中取帧，所有使用者释放后缓冲区自动归还，避免逐帧分配大块内存
+  // 在途帧数 = 检测流水线(mt_infer_requests) + 相机队列 + 录像/调试等，超出时临时从堆上分配
+  tools::FramePool frame_pool_{8, true};
+
+  // 以帧的设备时间戳代替取图后的now()，去掉传输和取图循环的抖动，相机重连后自动重新拟合
+  tools::ClockModel clock_model_;
+
+  // 守护线程阻塞到running被置为false(断流)后返回true，quit被置位时返回false
+  // 返回前再等待100ms，相机未接入时不会反复重置USB
+  bool wait_for_restart(const std::atomic<bool> & running, const std::atomic<bool> & quit);
+
+  // 修改running或quit须经此函数，持锁修改避免守护线程错过唤醒
+  void notify_daemon(std::atomic<bool> & flag, bool value);
+
+private:
+  std::mutex daemon_mutex_;
+  std::condition_variable daemon_condition_;
 };
 
 class Camera
@@ -20,8 +51,14 @@ class Camera
 public:
   Camera(const std::string & config_path);
   void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp);
+  tools::FramePool::Stats frame_pool_stats() const;
+  tools::ClockModel::Metrics clock_metrics() const;
+
+  // yaml中的camera_format，非bgr时read得到的是相机的原始数据
+  tools::PixelFormat format() const { return format_; }
 
 private:
+  tools::PixelFormat format_;
   std::unique_ptr<CameraBase> camera_;
 };
 
@@ -0,0 +1,139 @@
+#include "can_tx_scheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "tools/logger.hpp"
+
+namespace io
+{
+// 总线拥塞后的重试间隔
+constexpr auto BUSY_BACKOFF = std::chrono::milliseconds(1);
+
+static bool same(const can_frame & a, const can_frame & b)
+{
+  return a.can_id == b.can_id && a.can_dlc == b.can_dlc &&
+         std::memcmp(a.data, b.data, std::min<int>(a.can_dlc, CAN_MAX_DLEN)) == 0;
+}
+
+CANTxScheduler::CANTxScheduler(SocketCAN & can, double max_rate, double keepalive)
+: can_(can),
+  period_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / max_rate))),
+  keepalive_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(keepalive)))
+{
+  thread_ = std::thread(&CANTxScheduler::run, this);
+}
+
+CANTxScheduler::~CANTxScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+void CANTxScheduler::submit(const can_frame & frame)
+{
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.submitted++;
+
+    auto & channel = channels_[frame.can_id];
+    if (channel.has_pending) {
+      stats_.coalesced++;
+    } else if (
+      channel.has_last && same(channel.last, frame) && now - channel.last_sent < keepalive_) {
+      stats_.suppressed++;
+      return;
+    } else {
+      channel.submitted = now;
+    }
+
+    channel.pending = frame;
+    channel.has_pending = true;
+  }
+  condition_.notify_one();
+}
+
+CANTxScheduler::Stats CANTxScheduler::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto stats = stats_;
+  stats.latency_mean = stats_.sent ? latency_sum_ / stats_.sent : 0.0;
+  return stats;
+}
+
+void CANTxScheduler::run()
+{
+  auto last_log_time = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!quit_) {
+    // 已到发送时刻的帧中，先发等待最久的，各ID之间保持提交顺序
+    auto now = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::time_point::max();
+    Channel * ready = nullptr;
+    for (auto & [id, channel] : channels_) {
+      if (!channel.has_pending) continue;
+
+      auto due = std::max(channel.retry_at, channel.has_last ? channel.last_sent + period_ : now);
+      if (due > now)
+        next = std::min(next, due);
+      else if (!ready || channel.submitted < ready->submitted)
+        ready = &channel;
+    }
+
+    if (!ready) {
+      if (next == std::chrono::steady_clock::time_point::max())
+        condition_.wait(lock);
+      else
+        condition_.wait_until(lock, next);
+      continue;
+    }
+
+    // 写入时不持锁，调用者可以继续提交
+    auto frame = ready->pending;
+    auto submitted = ready->submitted;
+    lock.unlock();
+    auto error = can_.try_write(frame);
+    auto written = std::chrono::steady_clock::now();
+    lock.lock();
+
+    if (error == ENOBUFS || error == EAGAIN) {
+      stats_.busy++;
+      ready->retry_at = written + BUSY_BACKOFF;
+      continue;
+    }
+
+    // 写入期间提交的新帧继续等待发送
+    auto replaced = !same(ready->pending, frame);
+    if (!replaced) ready->has_pending = false;
+
+    if (error == 0) {
+      auto latency = std::chrono::duration<double>(written - submitted).count();
+      stats_.sent++;
+      latency_sum_ += latency;
+      stats_.latency_max = std::max(stats_.latency_max, latency);
+      ready->last = frame;
+      ready->has_last = true;
+      ready->last_sent = written;
+      continue;
+    }
+
+    stats_.errors++;
+
+    // 限制日志输出频率为1Hz
+    if (written - last_log_time >= std::chrono::seconds(1)) {
+      tools::logger()->warn("[CANTxScheduler] Failed to write: {}", std::strerror(error));
+      last_log_time = written;
+    }
+  }
+}
+
+}  // namespace io
@@ -0,0 +1,71 @@
+#ifndef IO__CAN_TX_SCHEDULER_HPP
+#define IO__CAN_TX_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "io/socketcan.hpp"
+
+namespace io
+{
+// CAN发送调度：调用者只提交帧，由专门的线程写入总线，写错误和总线拥塞不会阻塞控制循环
+// 每个ID只保留最新的一帧，发送频率不超过max_rate；内容与上次发送相同的帧只在超过keepalive后重发
+class CANTxScheduler
+{
+public:
+  struct Stats
+  {
+    std::size_t submitted;   // submit的调用次数
+    std::size_t sent;        // 成功写入的帧数
+    std::size_t coalesced;   // 发送前被同ID的新帧覆盖
+    std::size_t suppressed;  // 内容未变且未到keepalive，未发送
+    std::size_t busy;        // 发送队列满(ENOBUFS/EAGAIN)，稍后重试
+    std::size_t errors;      // 其他写错误，帧被丢弃
+    double latency_mean;     // 从submit到写入成功，单位：s
+    double latency_max;
+  };
+
+  // max_rate单位：Hz；keepalive单位：s，为0时内容不变也按max_rate发送
+  CANTxScheduler(SocketCAN & can, double max_rate, double keepalive);
+  ~CANTxScheduler();
+
+  // 不阻塞
+  void submit(const can_frame & frame);
+
+  Stats stats() const;
+
+private:
+  struct Channel
+  {
+    can_frame pending;
+    bool has_pending = false;
+    std::chrono::steady_clock::time_point submitted;
+    std::chrono::steady_clock::time_point retry_at;  // 总线拥塞后的重试时刻
+
+    can_frame last;
+    bool has_last = false;
+    std::chrono::steady_clock::time_point last_sent;
+  };
+
+  SocketCAN & can_;
+  std::chrono::steady_clock::duration period_;
+  std::chrono::steady_clock::duration keepalive_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::map<canid_t, Channel> channels_;  // 只增不删，发送线程可以在解锁期间持有指针
+  Stats stats_{};
+  double latency_sum_ = 0;
+  bool quit_ = false;
+  std::thread thread_;
+
+  void run();
+};
+
+}  // namespace io
+
+#endif  // IO__CAN_TX_SCHEDULER_HPP
@@ -9,42 +9,23 @@ CBoard::CBoard(const std::string & config_path)
 : mode(Mode::idle),
   shoot_mode(ShootMode::left_shoot),
   bullet_speed(0),
-  queue_(5000),
-  can_(read_yaml(config_path), std::bind(&CBoard::callback, this, std::placeholders::_1))
+  can_(
+    read_yaml(config_path),
+    std::bind(&CBoard::callback, this, std::placeholders::_1, std::placeholders::_2)),
+  tx_(can_, read_tx_rate(config_path), read_tx_keepalive(config_path))
 // 注意: callback的运行会早于Cboard构造函数的完成
 {
   tools::logger()->info("[Cboard] Waiting for q...");
-  queue_.pop(data_ahead_);
-  queue_.pop(data_behind_);
+  history_.wait(2);
   tools::logger()->info("[Cboard] Opened.");
 }
 
-Eigen::Quaterniond CBoard::imu_at(std::chrono::steady_clock::time_point timestamp)
+Eigen::Quaterniond CBoard::imu_at(std::chrono::steady_clock::time_point timestamp) const
 {
-  if (data_behind_.timestamp < timestamp) data_ahead_ = data_behind_;
-
-  while (true) {
-    queue_.pop(data_behind_);
-    if (data_behind_.timestamp > timestamp) break;
-    data_ahead_ = data_behind_;
-  }
-
-  Eigen::Quaterniond q_a = data_ahead_.q.normalized();
-  Eigen::Quaterniond q_b = data_behind_.q.normalized();
-  auto t_a = data_ahead_.timestamp;
-  auto t_b = data_behind_.timestamp;
-  auto t_c = timestamp;
-  std::chrono::duration<double> t_ab = t_b - t_a;
-  std::chrono::duration<double> t_ac = t_c - t_a;
-
-  // 四元数插值
-  auto k = t_ac / t_ab;
-  Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
-
-  return q_c;
+  return history_.at(timestamp);
 }
 
-void CBoard::send(Command command) const
+void CBoard::send(Command command)
 {
   can_frame frame;
   frame.can_id = send_canid_;
@@ -58,17 +39,14 @@ void CBoard::send(Command command) const
   frame.data[6] = (int16_t)(command.horizon_distance * 1e4) >> 8;
   frame.data[7] = (int16_t)(command.horizon_distance * 1e4);
 
-  try {
-    can_.write(&frame);
-  } catch (const std::exception & e) {
-    tools::logger()->warn("{}", e.what());
-  }
+  tx_.submit(frame);
 }
 
-void CBoard::callback(const can_frame & frame)
-{
-  auto timestamp = std::chrono::steady_clock::now();
+CANTxScheduler::Stats CBoard::tx_stats() const { return tx_.stats(); }
 
+// timestamp为内核收到该帧的时刻，不含接收线程的调度延迟
+void CBoard::callback(const can_frame & frame, std::chrono::steady_clock::time_point timestamp)
+{
   if (frame.can_id == quaternion_canid_) {
     auto x = (int16_t)(frame.data[0] << 8 | frame.data[1]) / 1e4;
     auto y = (int16_t)(frame.data[2] << 8 | frame.data[3]) / 1e4;
@@ -80,7 +58,7 @@ void CBoard::callback(const can_frame & frame)
       return;
     }
 
-    queue_.push({{w, x, y, z}, timestamp});
+    history_.push(timestamp, {w, x, y, z});
   }
 
   else if (frame.can_id == bullet_speed_canid_) {
@@ -118,4 +96,18 @@ std::string CBoard::read_yaml(const std::string & config_path)
   return yaml["can_interface"].as<std::string>();
 }
 
+// 可选，默认每个ID最高1000Hz
+double CBoard::read_tx_rate(const std::string & config_path)
+{
+  auto yaml = tools::load(config_path);
+  return yaml["can_tx_rate"].IsDefined() ? yaml["can_tx_rate"].as<double>() : 1000.0;
+}
+
+// 可选，默认内容不变时每10ms重发一次，防止下位机判定掉线
+double CBoard::read_tx_keepalive(const std::string & config_path)
+{
+  auto yaml = tools::load(config_path);
+  return yaml["can_tx_keepalive"].IsDefined() ? yaml["can_tx_keepalive"].as<double>() : 0.01;
+}
+
 }  // namespace io
\ No newline at end of file
@@ -8,10 +8,11 @@
 #include <string>
 #include <vector>
 
+#include "io/can_tx_scheduler.hpp"
 #include "io/command.hpp"
 #include "io/socketcan.hpp"
+#include "tools/attitude_history.hpp"
 #include "tools/logger.hpp"
-#include "tools/thread_safe_queue.hpp"
 
 namespace io
 {
@@ -44,27 +45,26 @@ public:
 
   CBoard(const std::string & config_path);
 
-  Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp);
+  // 不阻塞，可在多个线程中并发调用
+  Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp) const;
 
-  void send(Command command) const;
+  // 不阻塞，由发送线程写入总线，同一时刻只保留最新的指令
+  void send(Command command);
 
-private:
-  struct IMUData
-  {
-    Eigen::Quaterniond q;
-    std::chrono::steady_clock::time_point timestamp;
-  };
+  CANTxScheduler::Stats tx_stats() const;
 
-  tools::ThreadSafeQueue<IMUData> queue_;  // 必须在can_之前初始化，否则存在死锁的可能
+private:
+  tools::AttitudeHistory history_;  // 必须在can_之前初始化，callback会在构造函数完成前运行
   SocketCAN can_;
-  IMUData data_ahead_;
-  IMUData data_behind_;
+  CANTxScheduler tx_;
 
   int quaternion_canid_, bullet_speed_canid_, send_canid_;
 
-  void callback(const can_frame & frame);
+  void callback(const can_frame & frame, std::chrono::steady_clock::time_point timestamp);
 
   std::string read_yaml(const std::string & config_path);
+  static double read_tx_rate(const std::string & config_path);
+  static double read_tx_keepalive(const std::string & config_path);
 };
 
 }  // namespace io
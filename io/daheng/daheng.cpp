@@ -22,8 +22,22 @@ static void gx_check(GX_STATUS st, const char *what)
   throw std::runtime_error(std::string(what) + " failed");
 }
 
-Daheng::Daheng(double exposure_ms, double gain, const std::string & vid_pid)
-: exposure_ms_(exposure_ms), gain_(gain), quit_(false), ok_(false), queue_(1)
+// 相机输出的像素格式，BGR8及不支持的格式返回bgr
+static tools::PixelFormat native_format(int pix)
+{
+  switch (pix) {
+    case GX_PIXEL_FORMAT_RGB8: return tools::PixelFormat::rgb;
+    case GX_PIXEL_FORMAT_BAYER_RG8: return tools::PixelFormat::bayer_rg;
+    case GX_PIXEL_FORMAT_BAYER_GR8: return tools::PixelFormat::bayer_gr;
+    case GX_PIXEL_FORMAT_BAYER_GB8: return tools::PixelFormat::bayer_gb;
+    case GX_PIXEL_FORMAT_BAYER_BG8: return tools::PixelFormat::bayer_bg;
+    default: return tools::PixelFormat::bgr;
+  }
+}
+
+Daheng::Daheng(
+  double exposure_ms, double gain, const std::string & vid_pid, tools::PixelFormat format)
+: exposure_ms_(exposure_ms), gain_(gain), format_(format), quit_(false), ok_(false), queue_(1)
 {
   set_vid_pid(vid_pid);
   if (libusb_init(NULL)) tools::logger()->warn("Unable to init libusb!");
@@ -36,10 +50,8 @@ Daheng::Daheng(double exposure_ms, double gain, const std::string & vid_pid)
   // 守护线程：断流后重启相机并重置USB
   daemon_thread_ = std::thread{[this] {
     tools::logger()->info("Daheng's daemon thread started.");
-    while (!quit_) {
-      std::this_thread::sleep_for(100ms);
-      if (ok_) continue;
-
+    // 采集线程断流时被唤醒，不再轮询
+    while (wait_for_restart(ok_, quit_)) {
       if (capture_thread_.joinable()) capture_thread_.join();
       close();
       reset_usb();
@@ -51,7 +63,7 @@ Daheng::Daheng(double exposure_ms, double gain, const std::string & vid_pid)
 
 Daheng::~Daheng()
 {
-  quit_ = true;
+  notify_daemon(quit_, true);
   if (daemon_thread_.joinable()) daemon_thread_.join();
   if (capture_thread_.joinable()) capture_thread_.join();
   close();
@@ -94,38 +106,65 @@ void Daheng::open()
   // 连续采集
   gx_check(GXSetEnumValue(handle_, "TriggerMode", 0), "GXSetEnumValue(TriggerMode)");
 
+  // 设备时间戳的频率，不支持查询的型号按ns处理
+  GX_INT_VALUE tick_frequency = {};
+  st = GXGetIntValue(handle_, "TimestampTickFrequency", &tick_frequency);
+  tick_frequency_ =
+    (st == GX_STATUS_SUCCESS && tick_frequency.nCurValue > 0) ? tick_frequency.nCurValue : 1e9;
+  clock_model_.reset();
+
   gx_check(GXStreamOn(handle_), "GXStreamOn");
 
-  // 采集线程
+  // 在启动线程前置位，守护线程不会把正在启动的采集误判为断流
+  ok_ = true;
+
+  // 采集线程，GXDQBuf阻塞到新帧到达，帧一到就推入队列并唤醒read
   capture_thread_ = std::thread{[this] {
     tools::logger()->info("Daheng's capture thread started.");
-    ok_ = true;
 
+    // 像素格式在采集过程中不变，不匹配时只报错一次并丢弃帧，不向队列推入空图像
+    auto format_warned = false;
     while (!quit_) {
-      std::this_thread::sleep_for(1ms);
-
       PGX_FRAME_BUFFER pframe = nullptr;
       GX_STATUS st = GXDQBuf(handle_, &pframe, 100);
       if (st != GX_STATUS_SUCCESS) {
         tools::logger()->warn("GXDQBuf timeout or error: {}", (int)st);
-        ok_ = false;
+        notify_daemon(ok_, false);
         break;
       }
 
-      auto timestamp = std::chrono::steady_clock::now();
+      // 设备时间戳映射到主机时钟，再从曝光开始移到曝光中点
+      auto arrival = std::chrono::steady_clock::now();
+      auto timestamp = clock_model_.update(pframe->nTimestamp / tick_frequency_, arrival) -
+                       std::chrono::microseconds(static_cast<int64_t>(exposure_ms_ * 500));
 
       int w = pframe->nWidth;
       int h = pframe->nHeight;
       int pix = pframe->nPixelFormat;
 
+      // SDK的缓冲区在GXQBuf后会被覆盖，拷贝或转换到池中的帧
       cv::Mat img;
-      if (pix == GX_PIXEL_FORMAT_BGR8) {
-        img = cv::Mat(h, w, CV_8UC3, pframe->pImgBuf).clone();
+      if (format_ != tools::PixelFormat::bgr) {
+        // 保留原始数据，转换推迟到预处理或真正需要BGR图像时
+        if (native_format(pix) == format_) {
+          auto type = tools::is_bayer(format_) ? CV_8UC1 : CV_8UC3;
+          img = frame_pool_.acquire(h, w, type);
+          cv::Mat(h, w, type, pframe->pImgBuf).copyTo(img);
+        } else if (!format_warned) {
+          tools::logger()->error(
+            "Pixel format {} differs from camera_format, frames dropped!", pix);
+          format_warned = true;
+        }
+      } else if (pix == GX_PIXEL_FORMAT_BGR8) {
+        img = frame_pool_.acquire(h, w, CV_8UC3);
+        cv::Mat(h, w, CV_8UC3, pframe->pImgBuf).copyTo(img);
       } else if (pix == GX_PIXEL_FORMAT_RGB8) {
+        img = frame_pool_.acquire(h, w, CV_8UC3);
         cv::Mat rgb(h, w, CV_8UC3, pframe->pImgBuf);
         cv::cvtColor(rgb, img, cv::COLOR_RGB2BGR);
       } else if (pix == GX_PIXEL_FORMAT_BAYER_RG8 || pix == GX_PIXEL_FORMAT_BAYER_GR8 || pix == GX_PIXEL_FORMAT_BAYER_GB8 || pix == GX_PIXEL_FORMAT_BAYER_BG8) {
         // Bayer 去马赛克 -> 直接得到 BGR
+        img = frame_pool_.acquire(h, w, CV_8UC3);
         cv::Mat raw(h, w, CV_8UC1, pframe->pImgBuf);
         int code = cv::COLOR_BayerRG2BGR;
         switch (pix) {
@@ -135,18 +174,18 @@ void Daheng::open()
           case GX_PIXEL_FORMAT_BAYER_BG8: code = cv::COLOR_BayerBG2BGR; break;
         }
         cv::cvtColor(raw, img, code); // 得到真正 BGR
-      } else {
-        tools::logger()->warn("Unsupported pixel format: {}. Please set camera to 8-bit Bayer or RGB8/BGR8.", pix);
-        img = cv::Mat();
+      } else if (!format_warned) {
+        tools::logger()->error(
+          "Unsupported pixel format: {}. Please set camera to 8-bit Bayer or RGB8/BGR8.", pix);
+        format_warned = true;
       }
 
-
-      queue_.push({img, timestamp});
+      if (!img.empty()) queue_.push({img, timestamp});
 
       GX_STATUS st2 = GXQBuf(handle_, pframe);
       if (st2 != GX_STATUS_SUCCESS) {
         tools::logger()->warn("GXQBuf failed: {}", (int)st2);
-        ok_ = false;
+        notify_daemon(ok_, false);
         break;
       }
     }
@@ -21,7 +21,10 @@ class Daheng : public CameraBase
 {
 public:
 	// 简化构造：仅设定曝光、增益与可选 USB vid:pid（用于掉线时 reset）
-	Daheng(double exposure_ms, double gain, const std::string & vid_pid);
+	// format 非 bgr 时保留相机输出的 RGB 或 Bayer 原始数据，不在采集线程转换
+	Daheng(
+	  double exposure_ms, double gain, const std::string & vid_pid,
+	  tools::PixelFormat format = tools::PixelFormat::bgr);
 	~Daheng() override;
 	void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) override;
 
@@ -34,6 +37,8 @@ private:
 
 	double exposure_ms_;
 	double gain_;
+	tools::PixelFormat format_;
+	double tick_frequency_;  // 设备时间戳的频率，单位：Hz
 
 	std::thread daemon_thread_;
 	std::atomic<bool> quit_;
@@ -42,7 +47,7 @@ private:
 	GX_DEV_HANDLE handle_ = nullptr;
 
 	std::thread capture_thread_;
-	tools::ThreadSafeQueue<CameraData> queue_;
+	tools::ThreadSafeQueue<CameraData, true> queue_;
 
 	int vid_ = -1, pid_ = -1;
 
@@ -15,12 +15,11 @@
 
 namespace io
 {
-DM_IMU::DM_IMU() : queue_(5000)
+DM_IMU::DM_IMU()
 {
   init_serial();
   rec_thread_ = std::thread(&DM_IMU::get_imu_data_thread, this);
-  queue_.pop(data_ahead_);
-  queue_.pop(data_behind_);
+  history_.wait(2);
   tools::logger()->info("[DM_IMU] initialized");
 }
 
@@ -97,36 +96,19 @@ void DM_IMU::get_imu_data_thread()
                              Eigen::AngleAxisd(data.pitch * M_PI / 180, Eigen::Vector3d::UnitY()) *
                              Eigen::AngleAxisd(data.roll * M_PI / 180, Eigen::Vector3d::UnitX());
       q.normalize();
-      queue_.push({q, timestamp});
+
+      // 陀螺仪输出机体系角速度(rad/s)，用于查询时刻晚于最新样本时的外推
+      Eigen::Vector3d gyro(data.gyrox, data.gyroy, data.gyroz);
+      history_.push(timestamp, q, gyro);
     } else {
       tools::logger()->info("[DM_IMU] failed to get correct data");
     }
   }
 }
 
-Eigen::Quaterniond DM_IMU::imu_at(std::chrono::steady_clock::time_point timestamp)
+Eigen::Quaterniond DM_IMU::imu_at(std::chrono::steady_clock::time_point timestamp) const
 {
-  if (data_behind_.timestamp < timestamp) data_ahead_ = data_behind_;
-
-  while (true) {
-    queue_.pop(data_behind_);
-    if (data_behind_.timestamp > timestamp) break;
-    data_ahead_ = data_behind_;
-  }
-
-  Eigen::Quaterniond q_a = data_ahead_.q.normalized();
-  Eigen::Quaterniond q_b = data_behind_.q.normalized();
-  auto t_a = data_ahead_.timestamp;
-  auto t_b = data_behind_.timestamp;
-  auto t_c = timestamp;
-  std::chrono::duration<double> t_ab = t_b - t_a;
-  std::chrono::duration<double> t_ac = t_c - t_a;
-
-  // 四元数插值
-  auto k = t_ac / t_ab;
-  Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
-
-  return q_c;
+  return history_.at(timestamp);
 }
 
 }  // namespace io
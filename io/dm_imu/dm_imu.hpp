@@ -11,7 +11,7 @@
 #include <iostream>
 #include <thread>
 
-#include "tools/thread_safe_queue.hpp"
+#include "tools/attitude_history.hpp"
 
 namespace io
 {
@@ -68,14 +68,10 @@ public:
   DM_IMU();
   ~DM_IMU();
 
-  Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp);
+  // 不阻塞，可在多个线程中并发调用
+  Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp) const;
 
 private:
-  struct IMUData
-  {
-    Eigen::Quaterniond q;
-    std::chrono::steady_clock::time_point timestamp;
-  };
 
   void init_serial();
   void get_imu_data_thread();
@@ -83,8 +79,7 @@ private:
   serial::Serial serial_;
   std::thread rec_thread_;
 
-  tools::ThreadSafeQueue<IMUData> queue_;
-  IMUData data_ahead_, data_behind_;
+  tools::AttitudeHistory history_;
 
   std::atomic<bool> stop_thread_{false};
   IMU_Receive_Frame receive_data{};  //receive data frame
@@ -1,5 +1,7 @@
 #include "gimbal.hpp"
 
+#include <algorithm>
+
 #include "tools/crc.hpp"
 #include "tools/logger.hpp"
 #include "tools/math_tools.hpp"
@@ -7,13 +9,21 @@
 
 namespace io
 {
+// 连续多次等待超时(每次100ms)或读取出错后尝试重连
+constexpr int MAX_ERROR_COUNT = 10;
+
 Gimbal::Gimbal(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
   auto com_port = tools::read<std::string>(yaml, "com_port");
 
+  // 读取线程阻塞在waitReadable中，最多等待100ms以便检查quit_
+  serial::Timeout timeout;
+  timeout.read_timeout_constant = 100;
+
   try {
     serial_.setPort(com_port);
+    serial_.setTimeout(timeout);
     serial_.open();
   } catch (const std::exception & e) {
     tools::logger()->error("[Gimbal] Failed to open serial: {}", e.what());
@@ -21,14 +31,20 @@ Gimbal::Gimbal(const std::string & config_path)
   }
 
   thread_ = std::thread(&Gimbal::read_thread, this);
+  write_thread_ = std::thread(&Gimbal::write_thread, this);
 
-  queue_.pop();
+  history_.wait(1);
   tools::logger()->info("[Gimbal] First q received.");
 }
 
 Gimbal::~Gimbal()
 {
-  quit_ = true;
+  {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    quit_ = true;
+  }
+  tx_condition_.notify_all();
+  if (write_thread_.joinable()) write_thread_.join();
   if (thread_.joinable()) thread_.join();
   serial_.close();
 }
@@ -61,69 +77,62 @@ std::string Gimbal::str(GimbalMode mode) const
   }
 }
 
-Eigen::Quaterniond Gimbal::q(std::chrono::steady_clock::time_point t)
+Eigen::Quaterniond Gimbal::q(std::chrono::steady_clock::time_point t) const
 {
-  while (true) {
-    auto [q_a, t_a] = queue_.pop();
-    auto [q_b, t_b] = queue_.front();
-    auto t_ab = tools::delta_time(t_a, t_b);
-    auto t_ac = tools::delta_time(t_a, t);
-    auto k = t_ac / t_ab;
-    Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
-    if (t < t_a) return q_c;
-    if (!(t_a < t && t <= t_b)) continue;
-
-    return q_c;
-  }
+  return history_.at(t);
 }
 
 void Gimbal::send(io::VisionToGimbal VisionToGimbal)
 {
-  tx_data_.mode = VisionToGimbal.mode;
-  tx_data_.yaw = VisionToGimbal.yaw;
-  tx_data_.yaw_vel = VisionToGimbal.yaw_vel;
-  tx_data_.yaw_acc = VisionToGimbal.yaw_acc;
-  tx_data_.pitch = VisionToGimbal.pitch;
-  tx_data_.pitch_vel = VisionToGimbal.pitch_vel;
-  tx_data_.pitch_acc = VisionToGimbal.pitch_acc;
-  tx_data_.crc16 = tools::get_crc16(
-    reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_) - sizeof(tx_data_.crc16));
+  VisionToGimbal.head[0] = 'S';
+  VisionToGimbal.head[1] = 'P';
+  VisionToGimbal.crc16 = tools::get_crc16(
+    reinterpret_cast<uint8_t *>(&VisionToGimbal),
+    sizeof(VisionToGimbal) - sizeof(VisionToGimbal.crc16));
 
-  try {
-    serial_.write(reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_));
-  } catch (const std::exception & e) {
-    tools::logger()->warn("[Gimbal] Failed to write serial: {}", e.what());
+  {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    if (tx_pending_) {
+      std::lock_guard<std::mutex> stats_lock(mutex_);
+      stats_.tx_overwritten++;
+    }
+    tx_data_ = VisionToGimbal;
+    tx_pending_ = true;
   }
+  tx_condition_.notify_one();
 }
 
 void Gimbal::send(
   bool control, bool fire, float yaw, float yaw_vel, float yaw_acc, float pitch, float pitch_vel,
   float pitch_acc)
 {
-  tx_data_.mode = control ? (fire ? 2 : 1) : 0;
-  tx_data_.yaw = yaw;
-  tx_data_.yaw_vel = yaw_vel;
-  tx_data_.yaw_acc = yaw_acc;
-  tx_data_.pitch = pitch;
-  tx_data_.pitch_vel = pitch_vel;
-  tx_data_.pitch_acc = pitch_acc;
-  tx_data_.crc16 = tools::get_crc16(
-    reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_) - sizeof(tx_data_.crc16));
+  VisionToGimbal data;
+  data.mode = control ? (fire ? 2 : 1) : 0;
+  data.yaw = yaw;
+  data.yaw_vel = yaw_vel;
+  data.yaw_acc = yaw_acc;
+  data.pitch = pitch;
+  data.pitch_vel = pitch_vel;
+  data.pitch_acc = pitch_acc;
+  send(data);
+}
 
-  try {
-    serial_.write(reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_));
-  } catch (const std::exception & e) {
-    tools::logger()->warn("[Gimbal] Failed to write serial: {}", e.what());
-  }
+Gimbal::LinkStats Gimbal::link_stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
 }
 
-bool Gimbal::read(uint8_t * buffer, size_t size)
+// 一次读出缓冲区中已有的全部数据，没有数据时最多等待100ms
+std::size_t Gimbal::read()
 {
   try {
-    return serial_.read(buffer, size) == size;
+    if (!serial_.waitReadable()) return 0;
+    auto size = std::min(serial_.available(), parser_.writable());
+    return serial_.read(parser_.write_ptr(), size);
   } catch (const std::exception & e) {
     // tools::logger()->warn("[Gimbal] Failed to read serial: {}", e.what());
-    return false;
+    return 0;
   }
 }
 
@@ -133,37 +142,38 @@ void Gimbal::read_thread()
   int error_count = 0;
 
   while (!quit_) {
-    if (error_count > 5000) {
+    if (error_count > MAX_ERROR_COUNT) {
       error_count = 0;
       tools::logger()->warn("[Gimbal] Too many errors, attempting to reconnect...");
       reconnect();
       continue;
     }
 
-    if (!read(reinterpret_cast<uint8_t *>(&rx_data_), sizeof(rx_data_.head))) {
+    auto size = read();
+    if (size == 0) {
       error_count++;
       continue;
     }
 
-    if (rx_data_.head[0] != 'S' || rx_data_.head[1] != 'P') continue;
-
     auto t = std::chrono::steady_clock::now();
+    parser_.commit(size);
 
-    if (!read(
-          reinterpret_cast<uint8_t *>(&rx_data_) + sizeof(rx_data_.head),
-          sizeof(rx_data_) - sizeof(rx_data_.head))) {
-      error_count++;
-      continue;
-    }
+    // 一次读到多个包时，之前的包的到达时刻已无法得知，只使用最新的包
+    auto received = false;
+    parser_.parse([this, &received](const GimbalToVision & packet) {
+      rx_data_ = packet;
+      received = true;
+    });
 
-    if (!tools::check_crc16(reinterpret_cast<uint8_t *>(&rx_data_), sizeof(rx_data_))) {
-      tools::logger()->debug("[Gimbal] CRC16 check failed.");
-      continue;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.rx = parser_.stats();
     }
+    if (!received) continue;
 
     error_count = 0;
     Eigen::Quaterniond q(rx_data_.q[0], rx_data_.q[1], rx_data_.q[2], rx_data_.q[3]);
-    queue_.push({q, t});
+    history_.push(t, q);
 
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -197,6 +207,30 @@ void Gimbal::read_thread()
   tools::logger()->info("[Gimbal] read_thread stopped.");
 }
 
+void Gimbal::write_thread()
+{
+  while (true) {
+    VisionToGimbal data;
+    {
+      std::unique_lock<std::mutex> lock(tx_mutex_);
+      tx_condition_.wait(lock, [this] { return tx_pending_ || quit_; });
+      if (!tx_pending_) break;
+      data = tx_data_;
+      tx_pending_ = false;
+    }
+
+    try {
+      serial_.write(reinterpret_cast<uint8_t *>(&data), sizeof(data));
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.tx_sent++;
+    } catch (const std::exception & e) {
+      tools::logger()->warn("[Gimbal] Failed to write serial: {}", e.what());
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.tx_errors++;
+    }
+  }
+}
+
 void Gimbal::reconnect()
 {
   int max_retry_count = 10;
@@ -210,7 +244,8 @@ void Gimbal::reconnect()
 
     try {
       serial_.open();  // 尝试重新打开
-      queue_.clear();
+      parser_.clear();
+      history_.clear();
       tools::logger()->info("[Gimbal] Reconnected serial successfully.");
       break;
     } catch (const std::exception & e) {
@@ -4,13 +4,15 @@
 #include <Eigen/Geometry>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <string>
 #include <thread>
-#include <tuple>
 
+#include "io/gimbal/packet_parser.hpp"
 #include "serial/serial.h"
-#include "tools/thread_safe_queue.hpp"
+#include "tools/attitude_history.hpp"
 
 namespace io
 {
@@ -66,6 +68,14 @@ struct GimbalState
 class Gimbal
 {
 public:
+  struct LinkStats
+  {
+    PacketParser<GimbalToVision>::Stats rx;
+    std::size_t tx_sent;         // 成功写入串口的指令数
+    std::size_t tx_overwritten;  // 发送前被新指令覆盖的指令数
+    std::size_t tx_errors;
+  };
+
   Gimbal(const std::string & config_path);
 
   ~Gimbal();
@@ -73,31 +83,43 @@ public:
   GimbalMode mode() const;
   GimbalState state() const;
   std::string str(GimbalMode mode) const;
-  Eigen::Quaterniond q(std::chrono::steady_clock::time_point t);
+  // 不阻塞，可在多个线程中并发调用
+  Eigen::Quaterniond q(std::chrono::steady_clock::time_point t) const;
 
+  // 不阻塞，由发送线程写入串口，未发出的旧指令被新指令覆盖
+  // 析构时仍会发出最后一条指令
   void send(
     bool control, bool fire, float yaw, float yaw_vel, float yaw_acc, float pitch, float pitch_vel,
     float pitch_acc);
 
   void send(io::VisionToGimbal VisionToGimbal);
 
+  LinkStats link_stats() const;
+
 private:
   serial::Serial serial_;
 
   std::thread thread_;
+  std::thread write_thread_;
   std::atomic<bool> quit_ = false;
   mutable std::mutex mutex_;
 
+  PacketParser<GimbalToVision> parser_;  // 仅read_thread访问
   GimbalToVision rx_data_;
+
+  std::mutex tx_mutex_;
+  std::condition_variable tx_condition_;
   VisionToGimbal tx_data_;
+  bool tx_pending_ = false;
 
   GimbalMode mode_ = GimbalMode::IDLE;
   GimbalState state_;
-  tools::ThreadSafeQueue<std::tuple<Eigen::Quaterniond, std::chrono::steady_clock::time_point>>
-    queue_{1000};
+  LinkStats stats_{};
+  tools::AttitudeHistory history_;
 
-  bool read(uint8_t * buffer, size_t size);
+  std::size_t read();
   void read_thread();
+  void write_thread();
   void reconnect();
 };
 
@@ -0,0 +1,98 @@
+#ifndef IO__PACKET_PARSER_HPP
+#define IO__PACKET_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tools/crc.hpp"
+
+namespace io
+{
+// 串口字节流的分包器，Packet为以'S','P'开头、以crc16结尾的定长结构体
+// 串口数据整块写入缓冲区后一次解析出所有完整的包；用memchr查找帧头，
+// 帧头或CRC校验失败时只跳过一个字节，从下一个'S'重新同步，不会丢掉紧随其后的完整包
+template <typename Packet, std::size_t Capacity = 4096>
+class PacketParser
+{
+  static_assert(Capacity >= 2 * sizeof(Packet));
+
+public:
+  struct Stats
+  {
+    std::size_t packets;     // 校验通过的包数
+    std::size_t crc_errors;  // 帧头正确但CRC校验失败的次数
+    std::size_t skipped;     // 重新同步时丢弃的字节数
+  };
+
+  // 可写入的连续空间，写入后调用commit
+  // 解析后剩余的不足一包的数据被移到缓冲区开头，可写空间总不小于Capacity - sizeof(Packet)
+  uint8_t * write_ptr()
+  {
+    if (begin_ > 0) {
+      std::memmove(buffer_, buffer_ + begin_, end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+    }
+    return buffer_ + end_;
+  }
+
+  std::size_t writable() const { return Capacity - end_ + begin_; }
+
+  void commit(std::size_t size) { end_ += size; }
+
+  // 对每个完整的包调用handler(const Packet &)
+  template <typename Handler>
+  void parse(Handler && handler)
+  {
+    while (end_ - begin_ >= sizeof(Packet)) {
+      auto * data = buffer_ + begin_;
+      auto * head = static_cast<const uint8_t *>(std::memchr(data, 'S', end_ - begin_));
+      if (head == nullptr) {
+        stats_.skipped += end_ - begin_;
+        begin_ = end_;
+        break;
+      }
+
+      stats_.skipped += head - data;
+      begin_ += head - data;
+      if (end_ - begin_ < sizeof(Packet)) break;
+
+      data = buffer_ + begin_;
+      if (data[1] != 'P') {
+        stats_.skipped++;
+        begin_++;
+        continue;
+      }
+
+      if (!tools::check_crc16(data, sizeof(Packet))) {
+        stats_.crc_errors++;
+        stats_.skipped++;
+        begin_++;
+        continue;
+      }
+
+      Packet packet;
+      std::memcpy(&packet, data, sizeof(Packet));
+      begin_ += sizeof(Packet);
+      stats_.packets++;
+      handler(packet);
+    }
+
+    if (begin_ == end_) begin_ = end_ = 0;
+  }
+
+  Stats stats() const { return stats_; }
+
+  // 丢弃缓冲区中的数据，用于重连后
+  void clear() { begin_ = end_ = 0; }
+
+private:
+  uint8_t buffer_[Capacity];
+  std::size_t begin_ = 0, end_ = 0;
+  Stats stats_{};
+};
+
+}  // namespace io
+
+#endif  // IO__PACKET_PARSER_HPP
@@ -2,15 +2,27 @@
 
 #include <libusb-1.0/libusb.h>
 
+#include <stdexcept>
+
 #include "tools/logger.hpp"
 
 using namespace std::chrono_literals;
 
 namespace io
 {
-HikRobot::HikRobot(double exposure_ms, double gain, const std::string & vid_pid)
-: exposure_us_(exposure_ms * 1e3), gain_(gain), queue_(1), daemon_quit_(false), vid_(-1), pid_(-1)
+HikRobot::HikRobot(
+  double exposure_ms, double gain, const std::string & vid_pid, tools::PixelFormat format)
+: exposure_us_(exposure_ms * 1e3),
+  gain_(gain),
+  format_(format),
+  queue_(1),
+  daemon_quit_(false),
+  vid_(-1),
+  pid_(-1)
 {
+  if (format_ == tools::PixelFormat::rgb)
+    throw std::runtime_error("HikRobot only supports bgr or bayer camera_format!");
+
   set_vid_pid(vid_pid);
   if (libusb_init(NULL)) tools::logger()->warn("Unable to init libusb!");
 
@@ -19,11 +31,8 @@ HikRobot::HikRobot(double exposure_ms, double gain, const std::string & vid_pid)
 
     capture_start();
 
-    while (!daemon_quit_) {
-      std::this_thread::sleep_for(100ms);
-
-      if (capturing_) continue;
-
+    // 采集线程断流时被唤醒，不再轮询
+    while (wait_for_restart(capturing_, daemon_quit_)) {
       capture_stop();
       reset_usb();
       capture_start();
@@ -37,7 +46,7 @@ HikRobot::HikRobot(double exposure_ms, double gain, const std::string & vid_pid)
 
 HikRobot::~HikRobot()
 {
-  daemon_quit_ = true;
+  notify_daemon(daemon_quit_, true);
   if (daemon_thread_.joinable()) daemon_thread_.join();
   tools::logger()->info("HikRobot destructed.");
 }
@@ -89,23 +98,30 @@ void HikRobot::capture_start()
   set_float_value("Gain", gain_);
   MV_CC_SetFrameRate(handle_, 150);
 
+  // USB3 Vision的设备时间戳以ns为单位，GigE相机读取实际频率
+  MVCC_INTVALUE_EX tick_frequency;
+  ret = MV_CC_GetIntValueEx(handle_, "GevTimestampTickFrequency", &tick_frequency);
+  tick_frequency_ = (ret == MV_OK && tick_frequency.nCurValue > 0) ? tick_frequency.nCurValue : 1e9;
+  clock_model_.reset();
+
   ret = MV_CC_StartGrabbing(handle_);
   if (ret != MV_OK) {
     tools::logger()->warn("MV_CC_StartGrabbing failed: {:#x}", ret);
     return;
   }
 
+  // 在启动线程前置位，守护线程不会把正在启动的采集误判为断流
+  capturing_ = true;
+
   capture_thread_ = std::thread{[this] {
     tools::logger()->info("HikRobot's capture thread started.");
 
-    capturing_ = true;
-
     MV_FRAME_OUT raw;
     MV_CC_PIXEL_CONVERT_PARAM cvt_param;
+    auto format_warned = false;
 
+    // MV_CC_GetImageBuffer阻塞到新帧到达，帧一到就推入队列并唤醒read
     while (!capture_quit_) {
-      std::this_thread::sleep_for(1ms);
-
       unsigned int ret;
       unsigned int nMsec = 100;
 
@@ -115,7 +131,12 @@ void HikRobot::capture_start()
         break;
       }
 
-      auto timestamp = std::chrono::steady_clock::now();
+      // 设备时间戳映射到主机时钟，再从曝光开始移到曝光中点
+      auto arrival = std::chrono::steady_clock::now();
+      auto ticks = (static_cast<uint64_t>(raw.stFrameInfo.nDevTimeStampHigh) << 32) |
+                   raw.stFrameInfo.nDevTimeStampLow;
+      auto timestamp = clock_model_.update(ticks / tick_frequency_, arrival) -
+                       std::chrono::microseconds(static_cast<int64_t>(exposure_us_ / 2));
       cv::Mat img(cv::Size(raw.stFrameInfo.nWidth, raw.stFrameInfo.nHeight), CV_8U, raw.pBufAddr);
 
       cvt_param.nWidth = raw.stFrameInfo.nWidth;
@@ -132,16 +153,41 @@ void HikRobot::capture_start()
       // ret = MV_CC_ConvertPixelType(handle_, &cvt_param);
       const auto & frame_info = raw.stFrameInfo;
       auto pixel_type = frame_info.enPixelType;
-      cv::Mat dst_image;
       const static std::unordered_map<MvGvspPixelType, cv::ColorConversionCodes> type_map = {
         {PixelType_Gvsp_BayerGR8, cv::COLOR_BayerGR2RGB},
         {PixelType_Gvsp_BayerRG8, cv::COLOR_BayerRG2RGB},
         {PixelType_Gvsp_BayerGB8, cv::COLOR_BayerGB2RGB},
         {PixelType_Gvsp_BayerBG8, cv::COLOR_BayerBG2RGB}};
-      cv::cvtColor(img, dst_image, type_map.at(pixel_type));
-      img = dst_image;
+      const static std::unordered_map<MvGvspPixelType, tools::PixelFormat> format_map = {
+        {PixelType_Gvsp_BayerGR8, tools::PixelFormat::bayer_gr},
+        {PixelType_Gvsp_BayerRG8, tools::PixelFormat::bayer_rg},
+        {PixelType_Gvsp_BayerGB8, tools::PixelFormat::bayer_gb},
+        {PixelType_Gvsp_BayerBG8, tools::PixelFormat::bayer_bg}};
+
+      // 像素格式在采集过程中不变，不匹配时只报错一次并丢弃帧，不向队列推入空图像
+      auto format = format_map.find(pixel_type);
+      auto format_ok = format != format_map.end() &&
+                       (format_ == tools::PixelFormat::bgr || format->second == format_);
+      if (!format_ok && !format_warned) {
+        tools::logger()->error(
+          "[HikRobot] Pixel type {:#x} is not 8-bit Bayer or differs from camera_format, "
+          "frames dropped!",
+          static_cast<unsigned int>(pixel_type));
+        format_warned = true;
+      }
 
-      queue_.push({img, timestamp});
+      if (format_ok) {
+        cv::Mat dst_image;
+        if (format_ == tools::PixelFormat::bgr) {
+          dst_image = frame_pool_.acquire(frame_info.nHeight, frame_info.nWidth, CV_8UC3);
+          cv::cvtColor(img, dst_image, type_map.at(pixel_type));
+        } else {
+          // 保留原始Bayer数据，去马赛克推迟到预处理或真正需要BGR图像时
+          dst_image = frame_pool_.acquire(frame_info.nHeight, frame_info.nWidth, CV_8UC1);
+          img.copyTo(dst_image);
+        }
+        queue_.push({dst_image, timestamp});
+      }
 
       ret = MV_CC_FreeImageBuffer(handle_, &raw);
       if (ret != MV_OK) {
@@ -150,7 +196,7 @@ void HikRobot::capture_start()
       }
     }
 
-    capturing_ = false;
+    notify_daemon(capturing_, false);
     tools::logger()->info("HikRobot's capture thread stopped.");
   }};
 }
@@ -16,7 +16,10 @@ namespace io
 class HikRobot : public CameraBase
 {
 public:
-  HikRobot(double exposure_ms, double gain, const std::string & vid_pid);
+  // format为bgr时在采集线程去马赛克，为Bayer格式时保留原始数据
+  HikRobot(
+    double exposure_ms, double gain, const std::string & vid_pid,
+    tools::PixelFormat format = tools::PixelFormat::bgr);
   ~HikRobot() override;
   void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) override;
 
@@ -29,6 +32,8 @@ private:
 
   double exposure_us_;
   double gain_;
+  tools::PixelFormat format_;
+  double tick_frequency_;  // 设备时间戳的频率，单位：Hz
 
   std::thread daemon_thread_;
   std::atomic<bool> daemon_quit_;
@@ -37,7 +42,7 @@ private:
   std::thread capture_thread_;
   std::atomic<bool> capturing_;
   std::atomic<bool> capture_quit_;
-  tools::ThreadSafeQueue<CameraData> queue_;
+  tools::ThreadSafeQueue<CameraData, true> queue_;
 
   int vid_, pid_;
 
@@ -27,11 +27,8 @@ MindVision::MindVision(double exposure_ms, double gamma, const std::string & vid
 
   // 守护线程
   daemon_thread_ = std::thread{[this] {
-    while (!quit_) {
-      std::this_thread::sleep_for(100ms);
-
-      if (ok_) continue;
-
+    // 采集线程断流时被唤醒，不再轮询
+    while (wait_for_restart(ok_, quit_)) {
       if (capture_thread_.joinable()) capture_thread_.join();
 
       close();
@@ -43,7 +40,7 @@ MindVision::MindVision(double exposure_ms, double gamma, const std::string & vid
 
 MindVision::~MindVision()
 {
-  quit_ = true;
+  notify_daemon(quit_, true);
   if (daemon_thread_.joinable()) daemon_thread_.join();
   if (capture_thread_.joinable()) capture_thread_.join();
   close();
@@ -85,26 +82,38 @@ void MindVision::open()
 
   CameraPlay(handle_);
 
-  // 取图线程
+  // 在启动线程前置位，守护线程不会把正在启动的采集误判为断流
+  ok_ = true;
+
+  // 取图线程，CameraGetImageBuffer阻塞到新帧到达，帧一到就推入队列并唤醒read
   capture_thread_ = std::thread{[this] {
     tSdkFrameHead head;
     BYTE * raw;
 
-    ok_ = true;
-    while (!quit_) {
-      std::this_thread::sleep_for(1ms);
+    // uiTimeStamp以0.1ms为单位，32位约5天溢出一次，展开为连续的计数
+    uint32_t last_stamp = 0;
+    uint64_t wraps = 0;
+    clock_model_.reset();
 
-      auto img = cv::Mat(height_, width_, CV_8UC3);
+    while (!quit_) {
+      auto img = frame_pool_.acquire(height_, width_, CV_8UC3);
 
       auto status = CameraGetImageBuffer(handle_, &head, &raw, 100);
-      auto timestamp = std::chrono::steady_clock::now();
+      auto arrival = std::chrono::steady_clock::now();
 
       if (status != CAMERA_STATUS_SUCCESS) {
         tools::logger()->warn("Camera dropped!");
-        ok_ = false;
+        notify_daemon(ok_, false);
         break;
       }
 
+      // 设备时间戳映射到主机时钟，再从曝光开始移到曝光中点
+      if (head.uiTimeStamp < last_stamp) wraps++;
+      last_stamp = head.uiTimeStamp;
+      auto ticks = (wraps << 32) | head.uiTimeStamp;
+      auto timestamp = clock_model_.update(ticks * 1e-4, arrival) -
+                       std::chrono::microseconds(static_cast<int64_t>(exposure_ms_ * 500));
+
       CameraImageProcess(handle_, raw, img.data, &head);
       CameraReleaseImageBuffer(handle_, raw);
 
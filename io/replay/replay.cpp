@@ -0,0 +1,141 @@
+#include "replay.hpp"
+
+#include <fmt/core.h>
+
+#include <csignal>
+#include <fstream>
+#include <stdexcept>
+
+#include "tools/logger.hpp"
+
+namespace io
+{
+// 预先解码的帧数，帧取自FramePool，须给检测流水线留出足够的缓冲区
+constexpr std::size_t PREFETCH_FRAMES = 4;
+
+Replay::Replay(const std::string & path, bool realtime, bool loop)
+: video_path_(fmt::format("{}.avi", path)),
+  text_path_(fmt::format("{}.txt", path)),
+  realtime_(realtime),
+  loop_(loop),
+  quit_(false),
+  finished_(false),
+  started_(false)
+{
+  // 路径配置错误时在构造时报错，而不是让read一直等待
+  if (!cv::VideoCapture(video_path_).isOpened())
+    throw std::runtime_error("Failed to open " + video_path_ + "!");
+  if (!std::ifstream(text_path_).is_open())
+    throw std::runtime_error("Failed to open " + text_path_ + "!");
+
+  decode_thread_ = std::thread(&Replay::decode, this);
+
+  tools::logger()->info(
+    "[Replay] Playing {} {}.", video_path_, realtime_ ? "in realtime" : "as fast as possible");
+}
+
+Replay::~Replay()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  not_full_.notify_all();
+  if (decode_thread_.joinable()) decode_thread_.join();
+  tools::logger()->info("[Replay] Destructed.");
+}
+
+void Replay::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
+{
+  auto since_start = [](double t) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(t));
+  };
+  auto to_time_point = [&](double t) { return start_ + since_start(t); };
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return !queue_.empty() || finished_; });
+
+  // 播放完毕，通知tools::Exiter退出，在程序退出前重复最后一帧
+  if (queue_.empty()) {
+    lock.unlock();
+    std::raise(SIGINT);
+    img = last_.img;
+    timestamp = to_time_point(last_.t);
+    return;
+  }
+
+  auto data = std::move(queue_.front());
+  queue_.pop_front();
+
+  if (!started_) {
+    start_ = std::chrono::steady_clock::now() - since_start(data.t);
+    started_ = true;
+  }
+
+  // 实时播放时若后面的帧也已到时，丢弃当前帧，与相机队列只保留最新帧一致
+  if (realtime_) {
+    auto now = std::chrono::steady_clock::now();
+    while (!queue_.empty() && to_time_point(queue_.front().t) <= now) {
+      data = std::move(queue_.front());
+      queue_.pop_front();
+    }
+  }
+
+  last_ = data;
+  lock.unlock();
+  not_full_.notify_one();
+
+  timestamp = to_time_point(data.t);
+  if (realtime_) std::this_thread::sleep_until(timestamp);
+  img = data.img;
+}
+
+void Replay::decode()
+{
+  tools::logger()->info("[Replay] Decode thread started.");
+
+  // 循环播放时前几轮的总时长，保证时间戳单调递增
+  double offset = 0;
+
+  while (true) {
+    cv::VideoCapture video(video_path_);
+    std::ifstream text(text_path_);
+    auto width = static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH));
+    auto height = static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT));
+
+    int frames = 0;
+    double last_t = 0, dt = 0;
+    while (true) {
+      // 尺寸与视频一致时解码直接写入池中的缓冲区
+      auto img = frame_pool_.acquire(height, width, CV_8UC3);
+
+      double t, w, x, y, z;
+      if (!video.read(img) || img.empty() || !(text >> t >> w >> x >> y >> z)) break;
+
+      if (frames > 0) dt = t - last_t;
+      last_t = t;
+      frames++;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [this] { return queue_.size() < PREFETCH_FRAMES || quit_; });
+      if (quit_) return;
+      queue_.push_back({img, offset + t});
+      lock.unlock();
+      not_empty_.notify_one();
+    }
+
+    if (!loop_ || frames == 0) break;
+    offset += last_t + dt;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+  }
+  not_empty_.notify_all();
+
+  tools::logger()->info("[Replay] Finished.");
+}
+
+}  // namespace io
@@ -0,0 +1,60 @@
+#ifndef IO__REPLAY_HPP
+#define IO__REPLAY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+
+#include "io/camera.hpp"
+
+namespace io
+{
+// 播放tools::Recorder录制的avi和txt，代替相机做离线测试和无相机时的端到端性能测试
+// txt中的姿态不使用，姿态仍由CBoard/Gimbal提供
+class Replay : public CameraBase
+{
+public:
+  // path为avi和txt的路径(不含扩展名)
+  // realtime为true时按录制的时间戳节奏输出，处理不过来时与相机一样丢弃旧帧；为false时尽快输出
+  // loop为true时播放完毕后从头循环，否则发送SIGINT，由tools::Exiter正常结束程序
+  Replay(const std::string & path, bool realtime, bool loop);
+  ~Replay() override;
+  void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) override;
+
+private:
+  struct CameraData
+  {
+    cv::Mat img;
+    double t;  // 相对录制开始的时间，循环播放时继续累加，单位：s
+  };
+
+  std::string video_path_;
+  std::string text_path_;
+  bool realtime_;
+  bool loop_;
+
+  // 后台线程预先解码，read只需出队
+  std::thread decode_thread_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<CameraData> queue_;
+  bool quit_;
+  bool finished_;
+
+  // t为0的帧对应的时刻，在第一次read时确定
+  bool started_;
+  std::chrono::steady_clock::time_point start_;
+  CameraData last_;
+
+  void decode();
+};
+
+}  // namespace io
+
+#endif  // IO__REPLAY_HPP
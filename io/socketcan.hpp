@@ -5,8 +5,11 @@
 #include <net/if.h>
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <functional>
@@ -18,13 +21,18 @@
 using namespace std::chrono_literals;
 
 constexpr int MAX_EVENTS = 10;
+constexpr int RX_BATCH = 32;  // 一次recvmmsg最多取出的帧数
 
 namespace io
 {
 class SocketCAN
 {
 public:
-  SocketCAN(const std::string & interface, std::function<void(const can_frame & frame)> rx_handler)
+  // rx_handler的timestamp为内核收到该帧的时刻(SO_TIMESTAMPNS)，已换算到steady_clock
+  using RxHandler =
+    std::function<void(const can_frame & frame, std::chrono::steady_clock::time_point timestamp)>;
+
+  SocketCAN(const std::string & interface, RxHandler rx_handler)
   : interface_(interface),
     socket_fd_(-1),
     epoll_fd_(-1),
@@ -64,6 +72,13 @@ public:
       throw std::runtime_error("Unable to write!");
   }
 
+  // 不阻塞，成功返回0，失败返回errno，发送队列满时为ENOBUFS或EAGAIN
+  int try_write(const can_frame & frame) const
+  {
+    if (::send(socket_fd_, &frame, sizeof(can_frame), MSG_DONTWAIT) == -1) return errno;
+    return 0;
+  }
+
 private:
   std::string interface_;
   int socket_fd_;
@@ -72,9 +87,14 @@ private:
   bool ok_;
   std::thread read_thread_;
   std::thread daemon_thread_;
-  can_frame frame_;
   epoll_event events_[MAX_EVENTS];
-  std::function<void(const can_frame & frame)> rx_handler_;
+  RxHandler rx_handler_;
+
+  // recvmmsg的缓冲区，每帧附带一个存放时间戳的控制消息
+  can_frame frames_[RX_BATCH];
+  iovec iovs_[RX_BATCH];
+  mmsghdr msgs_[RX_BATCH];
+  char controls_[RX_BATCH][CMSG_SPACE(sizeof(timespec))];
 
   void open()
   {
@@ -95,6 +115,11 @@ private:
       throw std::runtime_error("Error binding socket to interface!");
     }
 
+    // 由内核在收到帧时打时间戳，不受接收线程调度延迟的影响
+    int enable = 1;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+      tools::logger()->warn("SocketCAN: SO_TIMESTAMPNS unsupported, using receive time.");
+
     epoll_event ev;
     epoll_fd_ = epoll_create1(0);
     if (epoll_fd_ == -1) throw std::runtime_error("Error creating epoll file descriptor!");
@@ -104,12 +129,10 @@ private:
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, ev.data.fd, &ev))
       throw std::runtime_error("Error adding socket to epoll file descriptor!");
 
-    // 接收线程
+    // 接收线程，阻塞在epoll_wait上，有帧到达时一次取出所有积压的帧
     read_thread_ = std::thread([this]() {
       ok_ = true;
       while (!quit_) {
-        std::this_thread::sleep_for(10us);
-
         try {
           read();
         } catch (const std::exception & e) {
@@ -134,14 +157,53 @@ private:
 
   void read()
   {
-    int num_events = epoll_wait(epoll_fd_, events_, MAX_EVENTS, 2);
-    if (num_events == -1) throw std::runtime_error("Error wating for events!");
+    // 超时只用于检查quit_
+    int num_events = epoll_wait(epoll_fd_, events_, MAX_EVENTS, 100);
+    if (num_events == -1) {
+      if (errno == EINTR) return;
+      throw std::runtime_error("Error wating for events!");
+    }
+    if (num_events == 0) return;
+
+    while (true) {
+      for (int i = 0; i < RX_BATCH; i++) {
+        iovs_[i] = {&frames_[i], sizeof(can_frame)};
+        std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+        msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+        msgs_[i].msg_hdr.msg_control = controls_[i];
+        msgs_[i].msg_hdr.msg_controllen = sizeof(controls_[i]);
+      }
+
+      int num_frames = recvmmsg(socket_fd_, msgs_, RX_BATCH, MSG_DONTWAIT, nullptr);
+      if (num_frames == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+        throw std::runtime_error("Error reading from SocketCAN!");
+      }
 
-    for (int i = 0; i < num_events; i++) {
-      ssize_t num_bytes = recv(socket_fd_, &frame_, sizeof(can_frame), MSG_DONTWAIT);
-      if (num_bytes == -1) throw std::runtime_error("Error reading from SocketCAN!");
+      // 内核时间戳基于CLOCK_REALTIME，用同一时刻两个时钟的差换算到steady_clock
+      auto steady_now = std::chrono::steady_clock::now();
+      timespec realtime_now;
+      clock_gettime(CLOCK_REALTIME, &realtime_now);
+
+      for (int i = 0; i < num_frames; i++) {
+        auto timestamp = steady_now;
+        for (auto * cmsg = CMSG_FIRSTHDR(&msgs_[i].msg_hdr); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&msgs_[i].msg_hdr, cmsg)) {
+          if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPNS) continue;
+
+          timespec stamp;
+          std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+          auto age = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::seconds(realtime_now.tv_sec - stamp.tv_sec) +
+            std::chrono::nanoseconds(realtime_now.tv_nsec - stamp.tv_nsec));
+          timestamp = steady_now - age;
+        }
+
+        rx_handler_(frames_[i], timestamp);
+      }
 
-      rx_handler_(frame_);
+      if (num_frames < RX_BATCH) return;
     }
   }
 
@@ -42,7 +42,7 @@ int main(int argc, char * argv[])
   io::Camera camera(config_path);
 
   // 初始化识别器、解算器、追踪器、瞄准器
-  auto_buff::Buff_Detector detector(config_path);
+  auto_buff::Buff_Detector detector(config_path, true);
   auto_buff::Solver solver(config_path);
   auto_buff::SmallTarget target;
   // auto_buff::BigTarget target;
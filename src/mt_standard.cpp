@@ -60,6 +60,7 @@ int main(int argc, char * argv[])
 
   std::atomic<io::Mode> mode{io::Mode::idle};
   auto last_mode{io::Mode::idle};
+  auto last_report = std::chrono::steady_clock::now();
 
   auto detect_thread = std::thread([&]() {
     cv::Mat img;
@@ -97,6 +98,16 @@ int main(int argc, char * argv[])
 
       commandgener.push(targets, t, cboard.bullet_speed, ypr);  // 发送给决策线程
 
+      // 过载时检测器跳帧而不是累积延迟，定期输出跳帧情况
+      auto now = std::chrono::steady_clock::now();
+      if (tools::delta_time(now, last_report) > 1.0) {
+        auto [completed, dropped, stale] = detector.counters();
+        tools::logger()->info(
+          "[MultiThreadDetector] completed: {}, dropped: {}, stale: {}, latency: {:.1f}ms",
+          completed, dropped, stale, tools::delta_time(now, t) * 1e3);
+        last_report = now;
+      }
+
     }
 
     /// 打符
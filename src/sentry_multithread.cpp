@@ -36,7 +36,6 @@ int main(int argc, char * argv[])
 {
   tools::Exiter exiter;
   tools::Plotter plotter;
-  tools::Recorder recorder;
 
   cv::CommandLineParser cli(argc, argv, keys);
   if (cli.has("help")) {
@@ -48,6 +47,7 @@ int main(int argc, char * argv[])
   io::ROS2 ros2;
   io::CBoard cboard(config_path);
   io::Camera camera(config_path);
+  tools::Recorder recorder(30, camera.format());  // 原始Bayer图像在保存线程中转换
   io::USBCamera usbcam1("video0", config_path);
   io::USBCamera usbcam2("video2", config_path);
   io::USBCamera usbcam3("video4", config_path);
@@ -7,11 +7,11 @@
 #include "io/camera.hpp"
 #include "io/cboard.hpp"
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/cascade_detector.hpp"
 #include "tasks/auto_aim/multithread/commandgener.hpp"
 #include "tasks/auto_aim/shooter.hpp"
 #include "tasks/auto_aim/solver.hpp"
 #include "tasks/auto_aim/tracker.hpp"
-#include "tasks/auto_aim/yolo.hpp"
 #include "tools/exiter.hpp"
 #include "tools/img_tools.hpp"
 #include "tools/logger.hpp"
@@ -41,8 +41,8 @@ int main(int argc, char * argv[])
   io::CBoard cboard(config_path);
   io::Camera camera(config_path);
 
-  auto_aim::YOLO detector(config_path, false);
   auto_aim::Solver solver(config_path);
+  auto_aim::CascadeDetector detector(config_path, solver, false);
   auto_aim::Tracker tracker(config_path, solver);
   auto_aim::Aimer aimer(config_path);
   auto_aim::Shooter shooter(config_path);
@@ -53,6 +53,7 @@ int main(int argc, char * argv[])
 
   auto mode = io::Mode::idle;
   auto last_mode = io::Mode::idle;
+  std::list<auto_aim::Target> targets;
 
   while (!exiter.exit()) {
     camera.read(img, t);
@@ -70,9 +71,9 @@ int main(int argc, char * argv[])
 
     Eigen::Vector3d ypr = tools::eulers(solver.R_gimbal2world(), 2, 1, 0);
 
-    auto armors = detector.detect(img);
+    auto armors = detector.detect(img, t, targets);
 
-    auto targets = tracker.track(armors, t);
+    targets = tracker.track(armors, t);
 
     auto command = aimer.aim(targets, t, cboard.bullet_speed);
 
@@ -39,10 +39,10 @@ int main(int argc, char * argv[])
 
   tools::Exiter exiter;
   tools::Plotter plotter;
-  tools::Recorder recorder;
 
   io::Gimbal gimbal(config_path);
   io::Camera camera(config_path);
+  tools::Recorder recorder(30, camera.format());  // 原始Bayer图像在保存线程中转换
 
   auto_aim::YOLO yolo(config_path, true);
   auto_aim::Solver solver(config_path);
@@ -0,0 +1,166 @@
+#include "binarize.hpp"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUTO_AIM_BINARIZE_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUTO_AIM_BINARIZE_AVX2
+#endif
+
+namespace auto_aim
+{
+namespace
+{
+// 8位定点灰度系数，对应cv::COLOR_BGR2GRAY的0.114, 0.587, 0.299
+constexpr int B2Y = 29;
+constexpr int G2Y = 150;
+constexpr int R2Y = 77;
+
+void binarize_row_scalar(
+  const uchar * bgr, uchar * binary, schar * color, int begin, int end, int threshold)
+{
+  for (int x = begin; x < end; x++) {
+    int b = bgr[3 * x + 0];
+    int g = bgr[3 * x + 1];
+    int r = bgr[3 * x + 2];
+    int gray = (b * B2Y + g * G2Y + r * R2Y + 128) >> 8;
+    binary[x] = gray > threshold ? 255 : 0;
+    color[x] = static_cast<schar>((r >> 1) - (b >> 1));
+  }
+}
+
+#if defined(AUTO_AIM_BINARIZE_NEON)
+// 一次处理16个像素，vld3q_u8直接完成BGR解交织
+int binarize_row_simd(const uchar * bgr, uchar * binary, schar * color, int width, int threshold)
+{
+  const uint8x16_t thresh = vdupq_n_u8(static_cast<uint8_t>(threshold));
+  const uint8x8_t kb = vdup_n_u8(B2Y);
+  const uint8x8_t kg = vdup_n_u8(G2Y);
+  const uint8x8_t kr = vdup_n_u8(R2Y);
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x3_t px = vld3q_u8(bgr + 3 * x);
+
+    uint16x8_t lo = vmull_u8(vget_low_u8(px.val[0]), kb);
+    lo = vmlal_u8(lo, vget_low_u8(px.val[1]), kg);
+    lo = vmlal_u8(lo, vget_low_u8(px.val[2]), kr);
+    uint16x8_t hi = vmull_u8(vget_high_u8(px.val[0]), kb);
+    hi = vmlal_u8(hi, vget_high_u8(px.val[1]), kg);
+    hi = vmlal_u8(hi, vget_high_u8(px.val[2]), kr);
+
+    uint8x16_t gray = vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+    vst1q_u8(binary + x, vcgtq_u8(gray, thresh));
+
+    int8x16_t r = vreinterpretq_s8_u8(vshrq_n_u8(px.val[2], 1));
+    int8x16_t b = vreinterpretq_s8_u8(vshrq_n_u8(px.val[0], 1));
+    vst1q_s8(reinterpret_cast<int8_t *>(color + x), vsubq_s8(r, b));
+  }
+  return x;
+}
+
+#elif defined(AUTO_AIM_BINARIZE_AVX2)
+// 一次处理16个像素：SSSE3 pshufb解交织，AVX2 16位乘加
+// 构建时未开启-mavx2，因此按函数开启指令集并在运行时检测
+__attribute__((target("avx2"))) int binarize_row_simd(
+  const uchar * bgr, uchar * binary, schar * color, int width, int threshold)
+{
+  // clang-format off
+  const __m128i b_a = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i b_b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+  const __m128i b_c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+  const __m128i g_a = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i g_b = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+  const __m128i g_c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+  const __m128i r_a = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i r_b = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+  const __m128i r_c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+  // clang-format on
+
+  const __m256i kb = _mm256_set1_epi16(B2Y);
+  const __m256i kg = _mm256_set1_epi16(G2Y);
+  const __m256i kr = _mm256_set1_epi16(R2Y);
+  const __m256i round = _mm256_set1_epi16(128);
+  const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+  const __m128i thresh = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(threshold)), sign);
+  const __m128i low7 = _mm_set1_epi8(0x7f);
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const uchar * p = bgr + 3 * x;
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+
+    __m128i blue = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(a, b_a), _mm_shuffle_epi8(b, b_b)), _mm_shuffle_epi8(c, b_c));
+    __m128i green = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(a, g_a), _mm_shuffle_epi8(b, g_b)), _mm_shuffle_epi8(c, g_c));
+    __m128i red = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(a, r_a), _mm_shuffle_epi8(b, r_b)), _mm_shuffle_epi8(c, r_c));
+
+    __m256i sum = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(blue), kb);
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(green), kg));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(red), kr));
+    sum = _mm256_srli_epi16(_mm256_add_epi16(sum, round), 8);
+    __m128i gray =
+      _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+
+    // 无符号比较：异或0x80后转为有符号比较
+    __m128i mask = _mm_cmpgt_epi8(_mm_xor_si128(gray, sign), thresh);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(binary + x), mask);
+
+    __m128i r_half = _mm_and_si128(_mm_srli_epi16(red, 1), low7);
+    __m128i b_half = _mm_and_si128(_mm_srli_epi16(blue, 1), low7);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(color + x), _mm_sub_epi8(r_half, b_half));
+  }
+  return x;
+}
+
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+void binarize_row(const uchar * bgr, uchar * binary, schar * color, int width, int threshold)
+{
+  int x = 0;
+#if defined(AUTO_AIM_BINARIZE_NEON)
+  x = binarize_row_simd(bgr, binary, color, width, threshold);
+#elif defined(AUTO_AIM_BINARIZE_AVX2)
+  if (has_avx2) x = binarize_row_simd(bgr, binary, color, width, threshold);
+#endif
+  binarize_row_scalar(bgr, binary, color, x, width, threshold);
+}
+
+}  // namespace
+
+void binarize(const cv::Mat & bgr_img, double threshold, cv::Mat & binary_img, cv::Mat & color_img)
+{
+  CV_Assert(bgr_img.type() == CV_8UC3);
+
+  binary_img.create(bgr_img.size(), CV_8UC1);
+  color_img.create(bgr_img.size(), CV_8SC1);
+
+  // 与cv::threshold对8位图像的处理一致：src > floor(thresh)
+  auto thresh = cvFloor(threshold);
+  auto clamped = std::clamp(thresh, 0, 255);
+
+  // 按行分块并行，ROI等非连续图像同样适用
+  auto width = bgr_img.cols;
+  cv::parallel_for_(
+    cv::Range(0, bgr_img.rows),
+    [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; y++) {
+        binarize_row(
+          bgr_img.ptr<uchar>(y), binary_img.ptr<uchar>(y), color_img.ptr<schar>(y), width,
+          clamped);
+      }
+    },
+    std::max(1, bgr_img.rows / 64));
+
+  if (thresh < 0) binary_img.setTo(255);
+}
+
+}  // namespace auto_aim
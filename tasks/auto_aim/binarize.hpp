@@ -0,0 +1,17 @@
+#ifndef AUTO_AIM__BINARIZE_HPP
+#define AUTO_AIM__BINARIZE_HPP
+
+#include <opencv2/opencv.hpp>
+
+namespace auto_aim
+{
+// 单次遍历完成灰度化、二值化和红蓝差值计算，替代cvtColor + threshold + 逐点取色
+// binary_img: CV_8UC1，灰度 > threshold 为255，否则为0
+//             灰度用8位定点系数计算，与cv::cvtColor的14位定点结果相差不超过1个灰度级，
+//             灰度恰在threshold附近的像素可能与cvtColor + cv::THRESH_BINARY不同
+// color_img:  CV_8SC1，(r >> 1) - (b >> 1)，对灯条区域求和即可判断颜色
+void binarize(const cv::Mat & bgr_img, double threshold, cv::Mat & binary_img, cv::Mat & color_img);
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__BINARIZE_HPP
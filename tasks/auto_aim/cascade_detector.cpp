@@ -0,0 +1,142 @@
+#include "cascade_detector.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+namespace auto_aim
+{
+CascadeDetector::CascadeDetector(
+  const std::string & config_path, const Solver & solver, bool debug)
+: yolo_(config_path, debug), solver_(solver), propagator_(config_path)
+{
+  auto yaml = YAML::LoadFile(config_path);
+
+  // 未配置时沿用整帧检测
+  auto mode = yaml["detect_mode"].IsDefined() ? yaml["detect_mode"].as<std::string>() : "full";
+  if (mode == "full")
+    cascade_ = false;
+  else if (mode == "cascade")
+    cascade_ = true;
+  else
+    throw std::runtime_error("Unknown detect_mode: " + mode + "!");
+
+  full_interval_ =
+    yaml["cascade_full_interval"].IsDefined() ? yaml["cascade_full_interval"].as<int>() : 10;
+  crop_margin_ =
+    yaml["cascade_crop_margin"].IsDefined() ? yaml["cascade_crop_margin"].as<double>() : 0.3;
+
+  // 默认每帧都做神经网络检测
+  flow_interval_ = yaml["flow_interval"].IsDefined() ? yaml["flow_interval"].as<int>() : 1;
+  flow_max_nis_ = yaml["flow_max_nis"].IsDefined() ? yaml["flow_max_nis"].as<double>() : 0.711;
+
+  if (cascade_)
+    tools::logger()->info(
+      "[CascadeDetector] cascade mode, full frame every {} frames, crop margin {:.2f}",
+      full_interval_, crop_margin_);
+
+  if (flow_interval_ > 1)
+    tools::logger()->info(
+      "[CascadeDetector] optical flow enabled, detect at least every {} frames, max nis {:.3f}",
+      flow_interval_, flow_max_nis_);
+}
+
+std::list<Armor> CascadeDetector::detect(
+  const cv::Mat & img, std::chrono::steady_clock::time_point t, const std::list<Target> & targets,
+  int frame_count)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  if (use_flow(targets)) {
+    auto armors = propagator_.propagate(img);
+    if (armors) {
+      flow_ms_ = tools::delta_time(std::chrono::steady_clock::now(), start) * 1e3;
+      flow_count_++;
+      last_is_flow_ = true;
+      return *armors;
+    }
+  }
+  flow_count_ = 0;
+  last_is_flow_ = false;
+
+  std::optional<cv::Rect> crop;
+  if (cascade_ && !img.empty() && !crop_missed_ && crop_count_ < full_interval_)
+    crop = get_crop(img.size(), t, targets);
+
+  std::list<Armor> armors;
+  if (crop) {
+    armors = yolo_.detect(img, *crop, frame_count);
+    crop_ms_ = tools::delta_time(std::chrono::steady_clock::now(), start) * 1e3;
+    crop_count_++;
+    crop_missed_ = armors.empty();
+    last_is_crop_ = true;
+    last_crop_ = *crop;
+  } else {
+    armors = yolo_.detect(img, frame_count);
+    full_ms_ = tools::delta_time(std::chrono::steady_clock::now(), start) * 1e3;
+    crop_count_ = 0;
+    crop_missed_ = false;
+    last_is_crop_ = false;
+    last_crop_ = cv::Rect(0, 0, img.cols, img.rows);
+  }
+
+  // 只传播正在跟踪的目标的装甲板
+  if (flow_interval_ > 1) {
+    auto tracked = armors;
+    if (!targets.empty()) {
+      auto name = targets.front().name;
+      tracked.remove_if([name](const Armor & a) { return a.name != name; });
+    }
+    propagator_.reset(img, tracked);
+  }
+
+  return armors;
+}
+
+bool CascadeDetector::use_flow(const std::list<Target> & targets) const
+{
+  if (flow_interval_ <= 1 || targets.empty() || propagator_.empty()) return false;
+
+  // 每flow_interval帧至少做一次神经网络检测，限制光流的累积漂移
+  if (flow_count_ + 1 >= flow_interval_) return false;
+
+  // NIS过大说明最近的观测与EKF的预测不符，需要检测结果纠正
+  return targets.front().ekf().data.at("nis") <= flow_max_nis_;
+}
+
+std::optional<cv::Rect> CascadeDetector::get_crop(
+  const cv::Size & img_size, std::chrono::steady_clock::time_point t,
+  const std::list<Target> & targets) const
+{
+  if (targets.empty()) return std::nullopt;
+
+  // 预测到本帧时刻，重投影整车所有装甲板
+  auto target = targets.front();
+  target.predict(t);
+
+  std::vector<cv::Point2f> points;
+  for (const auto & xyza : target.armor_xyza_list()) {
+    auto image_points =
+      solver_.reproject_armor(xyza.head(3), xyza[3], target.armor_type, target.name);
+    points.insert(points.end(), image_points.begin(), image_points.end());
+  }
+  auto box = cv::boundingRect(points);
+
+  // 边长取网络输入的2的幂次倍，目标足够小时以原分辨率输入，同时限制输入尺寸的种类
+  auto needed = std::max(box.width, box.height) * (1 + 2 * crop_margin_);
+  auto side = yolo_.input_size();
+  while (side < needed) side *= 2;
+  if (side >= std::min(img_size.width, img_size.height)) return std::nullopt;
+
+  // 以目标为中心，超出图像时平移回图像内
+  auto center = (box.tl() + box.br()) / 2;
+  auto x = std::clamp(center.x - side / 2, 0, img_size.width - side);
+  auto y = std::clamp(center.y - side / 2, 0, img_size.height - side);
+  return cv::Rect(x, y, side, side);
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,79 @@
+#ifndef AUTO_AIM__CASCADE_DETECTOR_HPP
+#define AUTO_AIM__CASCADE_DETECTOR_HPP
+
+#include <chrono>
+#include <list>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
+
+#include "armor.hpp"
+#include "keypoint_propagator.hpp"
+#include "solver.hpp"
+#include "target.hpp"
+#include "yolo.hpp"
+
+namespace auto_aim
+{
+// 两级检测，yaml中detect_mode可选：
+//   full:    整帧检测，与YOLO::detect相同(可用roi静态裁剪)
+//   cascade: 有跟踪目标时，在目标预测位置的重投影附近裁剪不小于网络输入的正方形区域检测，
+//            远处目标不再被缩小；每隔cascade_full_interval帧、无目标或裁剪区域未检出时整帧检测
+// flow_interval大于1时，两次神经网络检测之间用光流传播跟踪目标的装甲板角点；
+// 上一次EKF更新的NIS超过flow_max_nis或光流前后向误差过大时立即改为检测
+class CascadeDetector
+{
+public:
+  CascadeDetector(const std::string & config_path, const Solver & solver, bool debug = false);
+
+  // targets为上一帧Tracker的输出，t为本帧时间戳，调用前需已设置本帧的R_gimbal2world
+  // 结果均为整帧图像中的坐标
+  std::list<Armor> detect(
+    const cv::Mat & img, std::chrono::steady_clock::time_point t,
+    const std::list<Target> & targets, int frame_count = -1);
+
+  // 最近一次检测是否为裁剪检测，以及使用的区域
+  bool last_is_crop() const { return last_is_crop_; }
+  const cv::Rect & last_crop() const { return last_crop_; }
+
+  // 最近一次是否由光流传播得到结果，以及光流的前后向误差
+  bool last_is_flow() const { return last_is_flow_; }
+  double flow_residual() const { return propagator_.residual(); }
+
+  // 整帧检测、裁剪检测和光流传播各自最近一次的总耗时，单位ms
+  double full_ms() const { return full_ms_; }
+  double crop_ms() const { return crop_ms_; }
+  double flow_ms() const { return flow_ms_; }
+
+  double infer_ms() const { return yolo_.infer_ms(); }
+  double decode_ms() const { return yolo_.decode_ms(); }
+
+private:
+  YOLO yolo_;
+  const Solver & solver_;
+  KeypointPropagator propagator_;
+
+  bool cascade_;
+  int full_interval_;
+  double crop_margin_;
+  int flow_interval_;
+  double flow_max_nis_;
+
+  int crop_count_ = 0;  // 距上次整帧检测的裁剪检测次数
+  bool crop_missed_ = false;
+  bool last_is_crop_ = false;
+  cv::Rect last_crop_;
+  int flow_count_ = 0;  // 距上次神经网络检测的光流传播次数
+  bool last_is_flow_ = false;
+  double full_ms_ = 0, crop_ms_ = 0, flow_ms_ = 0;
+
+  bool use_flow(const std::list<Target> & targets) const;
+
+  std::optional<cv::Rect> get_crop(
+    const cv::Size & img_size, std::chrono::steady_clock::time_point t,
+    const std::list<Target> & targets) const;
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__CASCADE_DETECTOR_HPP
@@ -2,113 +2,106 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace auto_aim
 {
 Classifier::Classifier(const std::string & config_path)
+: input_(MAX_BATCH * INPUT_SIZE * INPUT_SIZE)
 {
   auto yaml = YAML::LoadFile(config_path);
   auto model = yaml["classify_model"].as<std::string>();
-  net_ = cv::dnn::readNetFromONNX(model);
+
+  // batch维设为有界动态，一次编译即可处理1~MAX_BATCH个图案
   auto ovmodel = core_.read_model(model);
+  ovmodel->reshape({ov::Dimension(1, MAX_BATCH), 1, INPUT_SIZE, INPUT_SIZE});
   compiled_model_ = core_.compile_model(
-    ovmodel, "AUTO", ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
+    ovmodel, "CPU", ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
+  infer_request_ = compiled_model_.create_infer_request();
+
+  batch_.reserve(MAX_BATCH);
 }
 
 void Classifier::classify(Armor & armor)
 {
-  if (armor.pattern.empty()) {
+  batch_.clear();
+  if (!fill(armor.pattern, input_.data())) {
     armor.name = ArmorName::not_armor;
     return;
   }
 
-  cv::Mat gray;
-  cv::cvtColor(armor.pattern, gray, cv::COLOR_BGR2GRAY);
-
-  auto input = cv::Mat(32, 32, CV_8UC1, cv::Scalar(0));
-  auto x_scale = static_cast<double>(32) / gray.cols;
-  auto y_scale = static_cast<double>(32) / gray.rows;
-  auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(gray.rows * scale);
-  auto w = static_cast<int>(gray.cols * scale);
+  batch_.push_back(&armor);
+  infer();
+}
 
-  if (h == 0 || w == 0) {
-    armor.name = ArmorName::not_armor;
-    return;
+template <typename Armors>
+void Classifier::classify_all(Armors & armors)
+{
+  batch_.clear();
+  for (auto & armor : armors) {
+    if (!fill(armor.pattern, input_.data() + batch_.size() * INPUT_SIZE * INPUT_SIZE)) {
+      armor.name = ArmorName::not_armor;
+      continue;
+    }
+
+    batch_.push_back(&armor);
+    if (batch_.size() == MAX_BATCH) infer();
   }
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(gray, input(roi), {w, h});
-
-  auto blob = cv::dnn::blobFromImage(input, 1.0 / 255.0, cv::Size(), cv::Scalar());
 
-  net_.setInput(blob);
-  cv::Mat outputs = net_.forward();
-
-  // softmax
-  float max = *std::max_element(outputs.begin<float>(), outputs.end<float>());
-  cv::exp(outputs - max, outputs);
-  float sum = cv::sum(outputs)[0];
-  outputs /= sum;
+  if (!batch_.empty()) infer();
+}
 
-  double confidence;
-  cv::Point label_point;
-  cv::minMaxLoc(outputs.reshape(1, 1), nullptr, &confidence, nullptr, &label_point);
-  int label_id = label_point.x;
+void Classifier::classify(std::list<Armor> & armors) { classify_all(armors); }
 
-  armor.confidence = confidence;
-  armor.name = static_cast<ArmorName>(label_id);
-}
+void Classifier::classify(std::vector<Armor> & armors) { classify_all(armors); }
 
-void Classifier::ovclassify(Armor & armor)
+bool Classifier::fill(const cv::Mat & pattern, float * slot) const
 {
-  if (armor.pattern.empty()) {
-    armor.name = ArmorName::not_armor;
-    return;
-  }
+  if (pattern.empty()) return false;
 
-  cv::Mat gray;
-  cv::cvtColor(armor.pattern, gray, cv::COLOR_BGR2GRAY);
-
-  // Resize image to 32x32
-  auto input = cv::Mat(32, 32, CV_8UC1, cv::Scalar(0));
-  auto x_scale = static_cast<double>(32) / gray.cols;
-  auto y_scale = static_cast<double>(32) / gray.rows;
+  // 等比缩放至32x32以内，左上角对齐，其余补0
+  auto x_scale = static_cast<double>(INPUT_SIZE) / pattern.cols;
+  auto y_scale = static_cast<double>(INPUT_SIZE) / pattern.rows;
   auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(gray.rows * scale);
-  auto w = static_cast<int>(gray.cols * scale);
-
-  if (h == 0 || w == 0) {
-    armor.name = ArmorName::not_armor;
-    return;
-  }
-
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(gray, input(roi), {w, h});
-  // Normalize the input image to [0, 1] range
-  input.convertTo(input, CV_32F, 1.0 / 255.0);
+  auto h = static_cast<int>(pattern.rows * scale);
+  auto w = static_cast<int>(pattern.cols * scale);
+  if (h == 0 || w == 0) return false;
+
+  // 先缩放再转灰度，只需处理不超过32x32个像素
+  cv::Mat resized, gray;
+  cv::resize(pattern, resized, {w, h});
+  cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
+
+  cv::Mat input(INPUT_SIZE, INPUT_SIZE, CV_32F, slot);
+  input.setTo(0);
+  gray.convertTo(input(cv::Rect(0, 0, w, h)), CV_32F, 1.0 / 255.0);
+  return true;
+}
 
-  ov::Tensor input_tensor(ov::element::f32, {1, 1, 32, 32}, input.data);
+void Classifier::infer()
+{
+  ov::Tensor input_tensor(
+    ov::element::f32, {batch_.size(), 1, INPUT_SIZE, INPUT_SIZE}, input_.data());
+  infer_request_.set_input_tensor(input_tensor);
+  infer_request_.infer();
 
-  ov::InferRequest infer_request = compiled_model_.create_infer_request();
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.infer();
+  auto output_tensor = infer_request_.get_output_tensor();
+  const float * outputs = output_tensor.data<float>();
 
-  auto output_tensor = infer_request.get_output_tensor();
-  auto output_shape = output_tensor.get_shape();
-  cv::Mat outputs(1, 9, CV_32F, output_tensor.data());
+  for (std::size_t i = 0; i < batch_.size(); i++) {
+    const float * logits = outputs + i * NUM_CLASSES;
 
-  // Softmax
-  float max = *std::max_element(outputs.begin<float>(), outputs.end<float>());
-  cv::exp(outputs - max, outputs);
-  float sum = cv::sum(outputs)[0];
-  outputs /= sum;
+    // softmax，只需最大类别的概率
+    auto max_it = std::max_element(logits, logits + NUM_CLASSES);
+    float sum = 0;
+    for (int j = 0; j < NUM_CLASSES; j++) sum += std::exp(logits[j] - *max_it);
 
-  double confidence;
-  cv::Point label_point;
-  cv::minMaxLoc(outputs.reshape(1, 1), nullptr, &confidence, nullptr, &label_point);
-  int label_id = label_point.x;
+    batch_[i]->confidence = 1.0 / sum;
+    batch_[i]->name = static_cast<ArmorName>(max_it - logits);
+  }
 
-  armor.confidence = confidence;
-  armor.name = static_cast<ArmorName>(label_id);
+  batch_.clear();
 }
 
-}  // namespace auto_aim
\ No newline at end of file
+}  // namespace auto_aim
@@ -1,9 +1,11 @@
 #ifndef AUTO_AIM__CLASSIFIER_HPP
 #define AUTO_AIM__CLASSIFIER_HPP
 
+#include <list>
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 #include <string>
+#include <vector>
 
 #include "armor.hpp"
 
@@ -16,14 +18,30 @@ public:
 
   void classify(Armor & armor);
 
-  void ovclassify(Armor & armor);
+  // 一帧内的候选装甲板合成一个batch推理，超过MAX_BATCH时分批
+  void classify(std::list<Armor> & armors);
+  void classify(std::vector<Armor> & armors);
 
 private:
-  cv::dnn::Net net_;
+  static constexpr int INPUT_SIZE = 32;
+  static constexpr int NUM_CLASSES = 9;
+  static constexpr std::size_t MAX_BATCH = 32;
+
   ov::Core core_;
   ov::CompiledModel compiled_model_;
+  ov::InferRequest infer_request_;
+
+  // MAX_BATCH x 1 x 32 x 32 的输入缓存，推理时直接作为输入张量
+  std::vector<float> input_;
+  std::vector<Armor *> batch_;
+
+  template <typename Armors>
+  void classify_all(Armors & armors);
+
+  bool fill(const cv::Mat & pattern, float * slot) const;
+  void infer();
 };
 
 }  // namespace auto_aim
 
-#endif  // AUTO_AIM__CLASSIFIER_HPP
\ No newline at end of file
+#endif  // AUTO_AIM__CLASSIFIER_HPP
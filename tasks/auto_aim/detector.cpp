@@ -1,125 +1,114 @@
 #include "detector.hpp"
 
-#include <fmt/chrono.h>
+#include <fmt/core.h>
 #include <yaml-cpp/yaml.h>
 
-#include <filesystem>
+#include <algorithm>
 
+#include "binarize.hpp"
 #include "tools/img_tools.hpp"
 #include "tools/logger.hpp"
+#include "tools/sample_sink.hpp"
 
 namespace auto_aim
 {
 Detector::Detector(const std::string & config_path, bool debug)
-: classifier_(config_path), debug_(debug)
+: classifier_(config_path),
+  lightbar_extractor_(config_path),
+  debug_(debug),
+  debug_sink_(tools::debug_sink(config_path))
 {
   auto yaml = YAML::LoadFile(config_path);
 
   threshold_ = yaml["threshold"].as<double>();
-  max_angle_error_ = yaml["max_angle_error"].as<double>() / 57.3;  // degree to rad
-  min_lightbar_ratio_ = yaml["min_lightbar_ratio"].as<double>();
-  max_lightbar_ratio_ = yaml["max_lightbar_ratio"].as<double>();
-  min_lightbar_length_ = yaml["min_lightbar_length"].as<double>();
   min_armor_ratio_ = yaml["min_armor_ratio"].as<double>();
   max_armor_ratio_ = yaml["max_armor_ratio"].as<double>();
   max_side_ratio_ = yaml["max_side_ratio"].as<double>();
   min_confidence_ = yaml["min_confidence"].as<double>();
   max_rectangular_error_ = yaml["max_rectangular_error"].as<double>() / 57.3;  // degree to rad
 
-  save_path_ = "patterns";
-  std::filesystem::create_directory(save_path_);
+  // 未配置时保持关闭
+  refine_lightbar_points_ = yaml["refine_lightbar_points"].IsDefined() &&
+                            yaml["refine_lightbar_points"].as<bool>();
 }
 
 std::list<Armor> Detector::detect(const cv::Mat & bgr_img, int frame_count)
 {
-  // 彩色图转灰度图
-  cv::Mat gray_img;
-  cv::cvtColor(bgr_img, gray_img, cv::COLOR_BGR2GRAY);
-
-  // 进行二值化
-  cv::Mat binary_img;
-  cv::threshold(gray_img, binary_img, threshold_, 255, cv::THRESH_BINARY);
-  cv::imshow("binary_img", binary_img);
-
-  // 获取轮廓点
-  std::vector<std::vector<cv::Point>> contours;
-  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+  // 单次遍历完成灰度化、二值化和红蓝差值计算
+  cv::Mat binary_img, color_img;
+  binarize(bgr_img, threshold_, binary_img, color_img);
 
   // 获取灯条
-  std::size_t lightbar_id = 0;
-  std::list<Lightbar> lightbars;
-  for (const auto & contour : contours) {
-    auto rotated_rect = cv::minAreaRect(contour);
-    auto lightbar = Lightbar(rotated_rect, lightbar_id);
-
-    if (!check_geometry(lightbar)) continue;
+  auto lightbars = lightbar_extractor_.extract(binary_img, color_img);
+
+  // 将灯条从左到右排序，id即为下标
+  std::sort(lightbars.begin(), lightbars.end(), [](const Lightbar & a, const Lightbar & b) {
+    return a.center.x < b.center.x;
+  });
+  for (std::size_t i = 0; i < lightbars.size(); i++) lightbars[i].id = i;
+
+  // 获取候选装甲板
+  std::vector<Armor> candidates;
+  for (std::size_t i = 0; i < lightbars.size(); i++) {
+    const auto & left = lightbars[i];
+
+    // width < max_armor_ratio * max_length < max_armor_ratio * max_side_ratio * left.length
+    // 灯条已按x排序，水平距离超过该上限后，更右侧的灯条都不可能配对
+    auto max_dx = max_armor_ratio_ * max_side_ratio_ * left.length;
+
+    for (std::size_t j = i + 1; j < lightbars.size(); j++) {
+      const auto & right = lightbars[j];
+      if (right.center.x - left.center.x >= max_dx) break;
+      if (left.color != right.color) continue;
+
+      // 构造Armor之前先检查长度比和宽长比
+      auto max_length = std::max(left.length, right.length);
+      auto min_length = std::min(left.length, right.length);
+      if (max_length >= max_side_ratio_ * min_length) continue;
+      auto ratio = cv::norm(right.center - left.center) / max_length;
+      if (ratio <= min_armor_ratio_ || ratio >= max_armor_ratio_) continue;
+
+      auto armor = Armor(left, right);
+      if (!check_geometry(armor)) continue;
 
-    lightbar.color = get_color(bgr_img, contour);
-    lightbars.emplace_back(lightbar);
-    lightbar_id += 1;
+      armor.pattern = get_pattern(bgr_img, armor);
+      candidates.emplace_back(std::move(armor));
+    }
   }
 
-  // 将灯条从左到右排序
-  lightbars.sort([](const Lightbar & a, const Lightbar & b) { return a.center.x < b.center.x; });
-
-  // 获取装甲板
-  std::list<Armor> armors;
-  for (auto left = lightbars.begin(); left != lightbars.end(); left++) {
-    for (auto right = std::next(left); right != lightbars.end(); right++) {
-      if (left->color != right->color) continue;
-
-      auto armor = Armor(*left, *right);
-      if (!check_geometry(armor)) continue;
+  // 所有候选装甲板合批分类
+  classifier_.classify(candidates);
 
-      armor.pattern = get_pattern(bgr_img, armor);
-      classifier_.classify(armor);
-      if (!check_name(armor)) continue;
+  std::vector<Armor> valid_armors;
+  for (auto & armor : candidates) {
+    if (!check_name(armor)) continue;
 
-      armor.type = get_type(armor);
-      if (!check_type(armor)) continue;
+    armor.type = get_type(armor);
+    if (!check_type(armor)) continue;
 
-      armor.center_norm = get_center_norm(bgr_img, armor.center);
-      armors.emplace_back(armor);
-    }
+    armor.center_norm = get_center_norm(bgr_img, armor.center);
+    valid_armors.emplace_back(std::move(armor));
   }
 
   // 检查装甲板是否存在共用灯条的情况
-  for (auto armor1 = armors.begin(); armor1 != armors.end(); armor1++) {
-    for (auto armor2 = std::next(armor1); armor2 != armors.end(); armor2++) {
-      if (
-        armor1->left.id != armor2->left.id && armor1->left.id != armor2->right.id &&
-        armor1->right.id != armor2->left.id && armor1->right.id != armor2->right.id) {
-        continue;
-      }
-
-      // 装甲板重叠, 保留roi小的
-      if (armor1->left.id == armor2->left.id || armor1->right.id == armor2->right.id) {
-        auto area1 = armor1->pattern.cols * armor1->pattern.rows;
-        auto area2 = armor2->pattern.cols * armor2->pattern.rows;
-        if (area1 < area2)
-          armor2->duplicated = true;
-        else
-          armor1->duplicated = true;
-      }
+  resolve_duplicates(valid_armors, lightbars.size());
 
-      // 装甲板相连，保留置信度大的
-      if (armor1->left.id == armor2->right.id || armor1->right.id == armor2->left.id) {
-        if (armor1->confidence < armor2->confidence)
-          armor1->duplicated = true;
-        else
-          armor2->duplicated = true;
-      }
-    }
+  std::list<Armor> armors;
+  for (auto & armor : valid_armors) {
+    if (!armor.duplicated) armors.emplace_back(std::move(armor));
   }
 
-  armors.remove_if([&](const Armor & a) { return a.duplicated; });
-
   if (debug_) show_result(binary_img, bgr_img, lightbars, armors, frame_count);
 
   return armors;
 }
 
 bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
+{
+  return detect(armor, bgr_img, tools::PixelFormat::bgr);
+}
+
+bool Detector::detect(Armor & armor, const cv::Mat & img, tools::PixelFormat format)
 {
   // 取得四个角点
   auto tl = armor.points[0];
@@ -145,47 +134,26 @@ bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
   cv::Rect boundingBox = armor_rotaterect.boundingRect();
   // 检查boundingBox是否超出图像边界
   if (
-    boundingBox.x < 0 || boundingBox.y < 0 || boundingBox.x + boundingBox.width > bgr_img.cols ||
-    boundingBox.y + boundingBox.height > bgr_img.rows) {
+    boundingBox.x < 0 || boundingBox.y < 0 || boundingBox.x + boundingBox.width > img.cols ||
+    boundingBox.y + boundingBox.height > img.rows) {
     return false;
   }
 
-  // 在图像上裁剪出这个矩形区域（ROI）
-  cv::Mat armor_roi = bgr_img(boundingBox);
+  // 在图像上裁剪出这个矩形区域（ROI），bgr格式时不拷贝
+  cv::Mat armor_roi = tools::to_bgr(img(boundingBox), format);
   if (armor_roi.empty()) {
     return false;
   }
 
-  // 彩色图转灰度图
-  cv::Mat gray_img;
-  cv::cvtColor(armor_roi, gray_img, cv::COLOR_BGR2GRAY);
-  // 进行二值化
-  cv::Mat binary_img;
-  cv::threshold(gray_img, binary_img, threshold_, 255, cv::THRESH_BINARY);
+  // 单次遍历完成灰度化、二值化和红蓝差值计算
+  cv::Mat binary_img, color_img;
+  binarize(armor_roi, threshold_, binary_img, color_img);
   // cv::imshow("binary_img", binary_img);
-  // 获取轮廓点
-  std::vector<std::vector<cv::Point>> contours;
-  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
   // 获取灯条
-  std::size_t lightbar_id = 0;
-  std::list<Lightbar> lightbars;
-  for (const auto & contour : contours) {
-    auto rotated_rect = cv::minAreaRect(contour);
-    auto lightbar = Lightbar(rotated_rect, lightbar_id);
-
-    if (!check_geometry(lightbar)) continue;
-
-    lightbar.color = get_color(bgr_img, contour);
-    // lightbar_points_corrector(lightbar, gray_img); //关闭PCA
-    lightbars.emplace_back(lightbar);
-    lightbar_id += 1;
-  }
+  auto lightbars = lightbar_extractor_.extract(binary_img, color_img);
 
   if (lightbars.size() < 2) return false;
 
-  // 将灯条从左到右排序
-  lightbars.sort([](const Lightbar & a, const Lightbar & b) { return a.center.x < b.center.x; });
-
   // 计算与 tl_roi, bl_roi 和 br_roi, tr_roi 距离最近的灯条
   Lightbar * closest_left_lightbar = nullptr;
   Lightbar * closest_right_lightbar = nullptr;
@@ -219,6 +187,15 @@ bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
   if (
     closest_left_lightbar && closest_right_lightbar &&
     min_distance_br_tr + min_distance_tl_bl < 15) {
+    // 只修正匹配上的两个灯条
+    if (refine_lightbar_points_) {
+      cv::Mat gray_img;
+      cv::cvtColor(armor_roi, gray_img, cv::COLOR_BGR2GRAY);
+      lightbar_extractor_.refine_points(*closest_left_lightbar, gray_img);
+      if (closest_right_lightbar != closest_left_lightbar)
+        lightbar_extractor_.refine_points(*closest_right_lightbar, gray_img);
+    }
+
     // 将四个点从armor_roi坐标系转换到原始图像坐标系
     armor.points[0] = closest_left_lightbar->top + cv::Point2f(boundingBox.x, boundingBox.y);
     armor.points[1] = closest_right_lightbar->top + cv::Point2f(boundingBox.x, boundingBox.y);
@@ -230,14 +207,6 @@ bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
   return false;
 }
 
-bool Detector::check_geometry(const Lightbar & lightbar) const
-{
-  auto angle_ok = lightbar.angle_error < max_angle_error_;
-  auto ratio_ok = lightbar.ratio > min_lightbar_ratio_ && lightbar.ratio < max_lightbar_ratio_;
-  auto length_ok = lightbar.length > min_lightbar_length_;
-  return angle_ok && ratio_ok && length_ok;
-}
-
 bool Detector::check_geometry(const Armor & armor) const
 {
   auto ratio_ok = armor.ratio > min_armor_ratio_ && armor.ratio < max_armor_ratio_;
@@ -246,6 +215,50 @@ bool Detector::check_geometry(const Armor & armor) const
   return ratio_ok && side_ratio_ok && rectangular_error_ok;
 }
 
+void Detector::resolve_duplicates(std::vector<Armor> & armors, std::size_t lightbar_num) const
+{
+  // 以灯条为键记录作为左/右灯条时roi最小、置信度最大的装甲板下标
+  std::vector<int> min_area_left(lightbar_num, -1), min_area_right(lightbar_num, -1);
+  std::vector<int> max_confidence_left(lightbar_num, -1), max_confidence_right(lightbar_num, -1);
+
+  auto area = [&](int i) { return armors[i].pattern.cols * armors[i].pattern.rows; };
+
+  // 面积相等时保留靠后的，置信度相等时保留靠前的，与两两比较的结果一致
+  auto update_min_area = [&](int & owner, int i) {
+    if (owner == -1 || area(i) <= area(owner)) owner = i;
+  };
+  auto update_max_confidence = [&](int & owner, int i) {
+    if (owner == -1 || armors[i].confidence > armors[owner].confidence) owner = i;
+  };
+  auto beaten_by = [&](int owner, int i) {
+    if (owner == -1) return false;
+    if (armors[owner].confidence != armors[i].confidence)
+      return armors[owner].confidence > armors[i].confidence;
+    return owner < i;
+  };
+
+  for (int i = 0; i < static_cast<int>(armors.size()); i++) {
+    update_min_area(min_area_left[armors[i].left.id], i);
+    update_min_area(min_area_right[armors[i].right.id], i);
+    update_max_confidence(max_confidence_left[armors[i].left.id], i);
+    update_max_confidence(max_confidence_right[armors[i].right.id], i);
+  }
+
+  for (int i = 0; i < static_cast<int>(armors.size()); i++) {
+    auto left = armors[i].left.id;
+    auto right = armors[i].right.id;
+
+    // 装甲板重叠, 保留roi小的
+    auto overlapped = min_area_left[left] != i || min_area_right[right] != i;
+
+    // 装甲板相连，保留置信度大的
+    auto connected =
+      beaten_by(max_confidence_right[left], i) || beaten_by(max_confidence_left[right], i);
+
+    armors[i].duplicated = overlapped || connected;
+  }
+}
+
 bool Detector::check_name(const Armor & armor) const
 {
   auto name_ok = armor.name != ArmorName::not_armor;
@@ -276,18 +289,6 @@ bool Detector::check_type(const Armor & armor) const
   return name_ok;
 }
 
-Color Detector::get_color(const cv::Mat & bgr_img, const std::vector<cv::Point> & contour) const
-{
-  int red_sum = 0, blue_sum = 0;
-
-  for (const auto & point : contour) {
-    red_sum += bgr_img.at<cv::Vec3b>(point)[2];
-    blue_sum += bgr_img.at<cv::Vec3b>(point)[0];
-  }
-
-  return blue_sum > red_sum ? Color::blue : Color::red;
-}
-
 cv::Mat Detector::get_pattern(const cv::Mat & bgr_img, const Armor & armor) const
 {
   // 延长灯条获得装甲板角点
@@ -346,146 +347,40 @@ cv::Point2f Detector::get_center_norm(const cv::Mat & bgr_img, const cv::Point2f
 
 void Detector::save(const Armor & armor) const
 {
-  auto file_name = fmt::format("{:%Y-%m-%d_%H-%M-%S}", std::chrono::system_clock::now());
-  auto img_path = fmt::format("{}/{}_{}.jpg", save_path_, ARMOR_NAMES[armor.name], file_name);
-  cv::imwrite(img_path, armor.pattern);
+  // 只拷贝图案，编码与写盘在后台线程完成
+  tools::sample_sink("patterns", ARMOR_NAMES).push(armor.pattern, armor.name);
 }
 
 void Detector::show_result(
-  const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::list<Lightbar> & lightbars,
+  const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::vector<Lightbar> & lightbars,
   const std::list<Armor> & armors, int frame_count) const
 {
-  auto detection = bgr_img.clone();
-  tools::draw_text(detection, fmt::format("[{}]", frame_count), {10, 30}, {255, 255, 255});
-
-  for (const auto & lightbar : lightbars) {
-    auto info = fmt::format(
-      "{:.1f} {:.1f} {:.1f} {}", lightbar.angle_error * 57.3, lightbar.ratio, lightbar.length,
-      COLORS[lightbar.color]);
-    tools::draw_text(detection, info, lightbar.top, {0, 255, 255});
-    tools::draw_points(detection, lightbar.points, {0, 255, 255}, 3);
-  }
-
-  for (const auto & armor : armors) {
-    auto info = fmt::format(
-      "{:.2f} {:.2f} {:.1f} {:.2f} {} {}", armor.ratio, armor.side_ratio,
-      armor.rectangular_error * 57.3, armor.confidence, ARMOR_NAMES[armor.name],
-      ARMOR_TYPES[armor.type]);
-    tools::draw_points(detection, armor.points, {0, 255, 0});
-    tools::draw_text(detection, info, armor.left.bottom, {0, 255, 0});
-  }
+  if (debug_sink_.ready("binary_img")) debug_sink_.submit("binary_img", binary_img);
 
-  cv::Mat binary_img2;
-  cv::resize(binary_img, binary_img2, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
-  cv::resize(detection, detection, {}, 0.5, 0.5);     // 显示时缩小图片尺寸
+  if (!debug_sink_.ready("detection")) return;
 
-  // cv::imshow("threshold", binary_img2);
-  cv::imshow("detection", detection);
-}
+  // 只拷贝检测结果，窗口模式下在本线程绘制，udp模式下在debug_sink的后台线程中绘制
+  debug_sink_.submit(
+    "detection", bgr_img, [lightbars, armors, frame_count](cv::Mat & detection) {
+      tools::draw_text(detection, fmt::format("[{}]", frame_count), {10, 30}, {255, 255, 255});
 
-void Detector::lightbar_points_corrector(Lightbar & lightbar, const cv::Mat & gray_img) const
-{
-  // 配置参数
-  constexpr float MAX_BRIGHTNESS = 25;  // 归一化最大亮度值
-  constexpr float ROI_SCALE = 0.07;     // ROI扩展比例
-  constexpr float SEARCH_START = 0.4;   // 搜索起始位置比例（原0.8/2）
-  constexpr float SEARCH_END = 0.6;     // 搜索结束位置比例（原1.2/2）
-
-  // 扩展并裁剪ROI
-  cv::Rect roi_box = lightbar.rotated_rect.boundingRect();
-  roi_box.x -= roi_box.width * ROI_SCALE;
-  roi_box.y -= roi_box.height * ROI_SCALE;
-  roi_box.width += 2 * roi_box.width * ROI_SCALE;
-  roi_box.height += 2 * roi_box.height * ROI_SCALE;
-
-  // 边界约束
-  roi_box &= cv::Rect(0, 0, gray_img.cols, gray_img.rows);
-
-  // 归一化ROI
-  cv::Mat roi = gray_img(roi_box);
-  const float mean_val = cv::mean(roi)[0];
-  roi.convertTo(roi, CV_32F);
-  cv::normalize(roi, roi, 0, MAX_BRIGHTNESS, cv::NORM_MINMAX);
-
-  // 计算质心
-  const cv::Moments moments = cv::moments(roi);
-  const cv::Point2f centroid(
-    moments.m10 / moments.m00 + roi_box.x, moments.m01 / moments.m00 + roi_box.y);
-
-  // 生成稀疏点云（优化性能）
-  std::vector<cv::Point2f> points;
-  for (int i = 0; i < roi.rows; ++i) {
-    for (int j = 0; j < roi.cols; ++j) {
-      const float weight = roi.at<float>(i, j);
-      if (weight > 1e-3) {          // 忽略极小值提升性能
-        points.emplace_back(j, i);  // 坐标相对于ROI区域
-      }
-    }
-  }
-
-  // PCA计算对称轴方向
-  cv::PCA pca(cv::Mat(points).reshape(1), cv::Mat(), cv::PCA::DATA_AS_ROW);
-  cv::Point2f axis(pca.eigenvectors.at<float>(0, 0), pca.eigenvectors.at<float>(0, 1));
-  axis /= cv::norm(axis);
-  if (axis.y > 0) axis = -axis;  // 统一方向
-
-  const auto find_corner = [&](int direction) -> cv::Point2f {
-    const float dx = axis.x * direction;
-    const float dy = axis.y * direction;
-    const float search_length = lightbar.length * (SEARCH_END - SEARCH_START);
-
-    std::vector<cv::Point2f> candidates;
-
-    // 横向采样多个候选线
-    const int half_width = (lightbar.width - 2) / 2;
-    for (int i_offset = -half_width; i_offset <= half_width; ++i_offset) {
-      // 计算搜索起点
-      cv::Point2f start_point(
-        centroid.x + lightbar.length * SEARCH_START * dx + i_offset,
-        centroid.y + lightbar.length * SEARCH_START * dy);
-
-      // 沿轴搜索亮度跳变点
-      cv::Point2f corner = start_point;
-      float max_diff = 0;
-      bool found = false;
-
-      for (float step = 0; step < search_length; ++step) {
-        const cv::Point2f cur_point(start_point.x + dx * step, start_point.y + dy * step);
-
-        // 边界检查
-        if (
-          cur_point.x < 0 || cur_point.x >= gray_img.cols || cur_point.y < 0 ||
-          cur_point.y >= gray_img.rows) {
-          break;
-        }
-
-        // 计算亮度差（使用双线性插值提升精度）
-        const auto prev_val = gray_img.at<uchar>(cv::Point2i(cur_point - cv::Point2f(dx, dy)));
-        const auto cur_val = gray_img.at<uchar>(cv::Point2i(cur_point));
-        const float diff = prev_val - cur_val;
-
-        if (diff > max_diff && prev_val > mean_val) {
-          max_diff = diff;
-          corner = cur_point - cv::Point2f(dx, dy);  // 跳变发生在上一位置
-          found = true;
-        }
+      for (const auto & lightbar : lightbars) {
+        auto info = fmt::format(
+          "{:.1f} {:.1f} {:.1f} {}", lightbar.angle_error * 57.3, lightbar.ratio,
+          lightbar.length, COLORS[lightbar.color]);
+        tools::draw_text(detection, info, lightbar.top, {0, 255, 255});
+        tools::draw_points(detection, lightbar.points, {0, 255, 255}, 3);
       }
 
-      if (found) {
-        candidates.push_back(corner);
+      for (const auto & armor : armors) {
+        auto info = fmt::format(
+          "{:.2f} {:.2f} {:.1f} {:.2f} {} {}", armor.ratio, armor.side_ratio,
+          armor.rectangular_error * 57.3, armor.confidence, ARMOR_NAMES[armor.name],
+          ARMOR_TYPES[armor.type]);
+        tools::draw_points(detection, armor.points, {0, 255, 0});
+        tools::draw_text(detection, info, armor.left.bottom, {0, 255, 0});
       }
-    }
-
-    // 返回候选点均值
-    return candidates.empty()
-             ? cv::Point2f(-1, -1)
-             : std::accumulate(candidates.begin(), candidates.end(), cv::Point2f(0, 0)) /
-                 static_cast<float>(candidates.size());
-  };
-
-  // 并行检测顶部和底部
-  lightbar.top = find_corner(1);
-  lightbar.bottom = find_corner(-1);
+    });
 }
 
 }  // namespace auto_aim
\ No newline at end of file
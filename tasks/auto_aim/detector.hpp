@@ -8,6 +8,9 @@
 
 #include "armor.hpp"
 #include "classifier.hpp"
+#include "lightbar_extractor.hpp"
+#include "tools/debug_sink.hpp"
+#include "tools/pixel_format.hpp"
 
 namespace auto_aim
 {
@@ -21,39 +24,37 @@ public:
 
   bool detect(Armor & armor, const cv::Mat & bgr_img);
 
+  // img为相机原始格式，只把装甲板附近的ROI转换为BGR
+  bool detect(Armor & armor, const cv::Mat & img, tools::PixelFormat format);
+
   friend class YOLOV8;
 
 private:
   Classifier classifier_;
+  LightbarExtractor lightbar_extractor_;
 
   double threshold_;
-  double max_angle_error_;
-  double min_lightbar_ratio_, max_lightbar_ratio_;
-  double min_lightbar_length_;
   double min_armor_ratio_, max_armor_ratio_;
   double max_side_ratio_;
   double min_confidence_;
   double max_rectangular_error_;
+  bool refine_lightbar_points_;
 
   bool debug_;
-  std::string save_path_;
-
-  // 利用PCA回归角点，参考自https://github.com/CSU-FYT-Vision/FYT2024_vision
-  void lightbar_points_corrector(Lightbar & lightbar, const cv::Mat & gray_img) const;
+  tools::DebugSink & debug_sink_;
 
-  bool check_geometry(const Lightbar & lightbar) const;
   bool check_geometry(const Armor & armor) const;
+  void resolve_duplicates(std::vector<Armor> & armors, std::size_t lightbar_num) const;
   bool check_name(const Armor & armor) const;
   bool check_type(const Armor & armor) const;
 
-  Color get_color(const cv::Mat & bgr_img, const std::vector<cv::Point> & contour) const;
   cv::Mat get_pattern(const cv::Mat & bgr_img, const Armor & armor) const;
   ArmorType get_type(const Armor & armor);
   cv::Point2f get_center_norm(const cv::Mat & bgr_img, const cv::Point2f & center) const;
 
   void save(const Armor & armor) const;
   void show_result(
-    const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::list<Lightbar> & lightbars,
+    const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::vector<Lightbar> & lightbars,
     const std::list<Armor> & armors, int frame_count) const;
 };
 
@@ -0,0 +1,119 @@
+#include "keypoint_propagator.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+
+namespace auto_aim
+{
+// 150fps下相邻帧角点位移一般在十几个像素以内，2层金字塔足以覆盖
+const cv::Size WIN_SIZE(15, 15);
+constexpr int MAX_LEVEL = 2;
+constexpr double PATCH_MARGIN = 1.0;  // 图块每侧扩展装甲板外接矩形长边的倍数
+
+KeypointPropagator::KeypointPropagator(const std::string & config_path)
+{
+  auto yaml = YAML::LoadFile(config_path);
+  max_residual_ =
+    yaml["flow_max_residual"].IsDefined() ? yaml["flow_max_residual"].as<double>() : 1.0;
+  format_ = tools::read_pixel_format(yaml);
+}
+
+void KeypointPropagator::reset(const cv::Mat & img, const std::list<Armor> & armors)
+{
+  tracks_.clear();
+  residual_ = 0;
+  if (img.empty()) return;
+
+  for (const auto & armor : armors) {
+    auto rect = patch_rect(armor.points, img.size());
+    if (rect.empty()) continue;
+
+    Track track{armor, rect, cv::Mat()};
+    crop_gray(img, rect, track.patch);
+    tracks_.emplace_back(std::move(track));
+  }
+}
+
+void KeypointPropagator::clear()
+{
+  tracks_.clear();
+  residual_ = 0;
+}
+
+std::optional<std::list<Armor>> KeypointPropagator::propagate(const cv::Mat & img)
+{
+  residual_ = 0;
+  if (tracks_.empty() || img.empty()) return std::nullopt;
+
+  std::list<Armor> armors;
+  for (auto & track : tracks_) {
+    // 本帧在上一帧图块的位置取图块，目标在图块内的移动交给金字塔处理
+    crop_gray(img, track.rect, gray_);
+
+    cv::Point2f tl = track.rect.tl();
+    prev_points_.clear();
+    for (const auto & point : track.armor.points) prev_points_.emplace_back(point - tl);
+
+    cv::calcOpticalFlowPyrLK(
+      track.patch, gray_, prev_points_, next_points_, status_, error_, WIN_SIZE, MAX_LEVEL);
+    cv::calcOpticalFlowPyrLK(
+      gray_, track.patch, next_points_, back_points_, back_status_, error_, WIN_SIZE, MAX_LEVEL);
+
+    for (std::size_t i = 0; i < prev_points_.size(); i++) {
+      if (!status_[i] || !back_status_[i]) {
+        tracks_.clear();
+        return std::nullopt;
+      }
+      residual_ = std::max(residual_, cv::norm(back_points_[i] - prev_points_[i]));
+    }
+
+    if (residual_ > max_residual_) {
+      tracks_.clear();
+      return std::nullopt;
+    }
+
+    auto & armor = track.armor;
+    for (std::size_t i = 0; i < next_points_.size(); i++)
+      armor.points[i] = next_points_[i] + tl;
+    armor.center = (armor.points[0] + armor.points[1] + armor.points[2] + armor.points[3]) / 4;
+    armor.center_norm = {armor.center.x / img.cols, armor.center.y / img.rows};
+    armor.box = cv::boundingRect(armor.points);
+
+    // 以传播后的角点更新图块，下一帧从本帧继续传播
+    auto rect = patch_rect(armor.points, img.size());
+    if (rect.empty()) {
+      tracks_.clear();
+      return std::nullopt;
+    }
+    track.rect = rect;
+    crop_gray(img, rect, track.patch);
+
+    armors.emplace_back(armor);
+  }
+
+  return armors;
+}
+
+cv::Rect KeypointPropagator::patch_rect(
+  const std::vector<cv::Point2f> & points, const cv::Size & img_size) const
+{
+  auto box = cv::boundingRect(points);
+  auto margin = static_cast<int>(std::max(box.width, box.height) * PATCH_MARGIN);
+
+  // 保证图块不小于光流窗口
+  margin = std::max(margin, WIN_SIZE.width);
+  box.x -= margin;
+  box.y -= margin;
+  box.width += 2 * margin;
+  box.height += 2 * margin;
+  return box & cv::Rect(0, 0, img_size.width, img_size.height);
+}
+
+void KeypointPropagator::crop_gray(const cv::Mat & img, const cv::Rect & rect, cv::Mat & gray) const
+{
+  // Bayer图像按图块在原图中的位置确定相位，直接去马赛克为灰度
+  tools::to_gray(img(rect), format_, gray);
+}
+
+}  // namespace auto_aim
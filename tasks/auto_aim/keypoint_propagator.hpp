@@ -0,0 +1,59 @@
+#ifndef AUTO_AIM__KEYPOINT_PROPAGATOR_HPP
+#define AUTO_AIM__KEYPOINT_PROPAGATOR_HPP
+
+#include <list>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "armor.hpp"
+#include "tools/pixel_format.hpp"
+
+namespace auto_aim
+{
+// 以最近一次检测结果为起点，用金字塔LK光流逐帧传播装甲板的4个角点
+// 只在装甲板附近的小图块上计算，并用前后向光流的误差检验传播是否可靠
+class KeypointPropagator
+{
+public:
+  explicit KeypointPropagator(const std::string & config_path);
+
+  // img为检测所用的图像，armors为检测结果
+  void reset(const cv::Mat & img, const std::list<Armor> & armors);
+  void clear();
+  bool empty() const { return tracks_.empty(); }
+
+  // 成功时返回角点更新后的装甲板，其余属性沿用检测结果
+  // 任一角点丢失或前后向误差超过flow_max_residual时返回nullopt，并清空状态
+  std::optional<std::list<Armor>> propagate(const cv::Mat & img);
+
+  // 最近一次传播中角点前后向误差的最大值，单位：pixel
+  double residual() const { return residual_; }
+
+private:
+  struct Track
+  {
+    Armor armor;
+    cv::Rect rect;  // 图块在整帧图像中的位置
+    cv::Mat patch;  // 上一帧的灰度图块
+  };
+
+  double max_residual_;
+  tools::PixelFormat format_;
+  double residual_ = 0;
+  std::vector<Track> tracks_;
+
+  // 以下缓冲区逐帧复用
+  cv::Mat gray_;
+  std::vector<cv::Point2f> prev_points_, next_points_, back_points_;
+  std::vector<uchar> status_, back_status_;
+  std::vector<float> error_;
+
+  cv::Rect patch_rect(const std::vector<cv::Point2f> & points, const cv::Size & img_size) const;
+  void crop_gray(const cv::Mat & img, const cv::Rect & rect, cv::Mat & gray) const;
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__KEYPOINT_PROPAGATOR_HPP
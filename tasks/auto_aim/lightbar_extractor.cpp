@@ -0,0 +1,276 @@
+#include "lightbar_extractor.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace auto_aim
+{
+LightbarExtractor::LightbarExtractor(const std::string & config_path)
+{
+  auto yaml = YAML::LoadFile(config_path);
+
+  max_angle_error_ = yaml["max_angle_error"].as<double>() / 57.3;  // degree to rad
+  min_lightbar_ratio_ = yaml["min_lightbar_ratio"].as<double>();
+  max_lightbar_ratio_ = yaml["max_lightbar_ratio"].as<double>();
+  min_lightbar_length_ = yaml["min_lightbar_length"].as<double>();
+
+  // 未配置时沿用轮廓法
+  use_components_ = yaml["lightbar_extractor"].IsDefined() &&
+                    yaml["lightbar_extractor"].as<std::string>() == "components";
+}
+
+std::vector<Lightbar> LightbarExtractor::extract(
+  const cv::Mat & binary_img, const cv::Mat & color_img) const
+{
+  if (use_components_) return extract_by_components(binary_img, color_img);
+  return extract_by_contours(binary_img, color_img);
+}
+
+std::vector<Lightbar> LightbarExtractor::extract_by_contours(
+  const cv::Mat & binary_img, const cv::Mat & color_img) const
+{
+  // 获取轮廓点
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+
+  // 获取灯条
+  std::size_t lightbar_id = 0;
+  std::vector<Lightbar> lightbars;
+  for (const auto & contour : contours) {
+    auto rotated_rect = cv::minAreaRect(contour);
+    auto lightbar = Lightbar(rotated_rect, lightbar_id);
+
+    if (!check_geometry(lightbar)) continue;
+
+    lightbar.color = get_color(color_img, contour);
+    lightbars.emplace_back(lightbar);
+    lightbar_id += 1;
+  }
+
+  return lightbars;
+}
+
+std::vector<Lightbar> LightbarExtractor::extract_by_components(
+  const cv::Mat & binary_img, const cv::Mat & color_img) const
+{
+  // 多线程连通域标记
+  cv::Mat labels, stats, centroids;
+  auto num = cv::connectedComponentsWithStats(
+    binary_img, labels, stats, centroids, 8, CV_32S, cv::CCL_DEFAULT);
+
+  std::size_t lightbar_id = 0;
+  std::vector<Lightbar> lightbars;
+  for (int label = 1; label < num; label++) {
+    const int * stat = stats.ptr<int>(label);
+    auto left = stat[cv::CC_STAT_LEFT];
+    auto top = stat[cv::CC_STAT_TOP];
+    auto w = stat[cv::CC_STAT_WIDTH];
+    auto h = stat[cv::CC_STAT_HEIGHT];
+
+    // 灯条长度不超过外接框对角线，至少需要两个像素才能求协方差
+    if (stat[cv::CC_STAT_AREA] < 2) continue;
+    if (std::hypot(w - 1, h - 1) <= min_lightbar_length_) continue;
+
+    // 只遍历外接框，累加一阶、二阶矩和红蓝差值
+    double n = 0, sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    int diff_sum = 0;
+    for (int y = 0; y < h; y++) {
+      const int * label_row = labels.ptr<int>(top + y) + left;
+      const schar * color_row = color_img.ptr<schar>(top + y) + left;
+
+      int row_n = 0, row_sx = 0;
+      int64_t row_sxx = 0;
+      for (int x = 0; x < w; x++) {
+        if (label_row[x] != label) continue;
+        row_n += 1;
+        row_sx += x;
+        row_sxx += x * x;
+        diff_sum += color_row[x];
+      }
+
+      n += row_n;
+      sx += row_sx;
+      sxx += row_sxx;
+      sy += static_cast<double>(row_n) * y;
+      syy += static_cast<double>(row_n) * y * y;
+      sxy += static_cast<double>(row_sx) * y;
+    }
+
+    // 协方差矩阵的特征值即长轴、短轴方向的方差，均匀分布的线段方差为 L^2 / 12
+    auto mx = sx / n, my = sy / n;
+    auto mu20 = sxx / n - mx * mx;
+    auto mu02 = syy / n - my * my;
+    auto mu11 = sxy / n - mx * my;
+    auto half_sum = (mu20 + mu02) / 2;
+    auto half_diff = std::sqrt((mu20 - mu02) * (mu20 - mu02) / 4 + mu11 * mu11);
+    auto length = std::sqrt(12 * (half_sum + half_diff));
+    auto width = std::sqrt(12 * std::max(half_sum - half_diff, 0.0));
+
+    // 在拟合旋转矩形之前用矩统计量剔除
+    if (length <= min_lightbar_length_) continue;
+    if (length <= min_lightbar_ratio_ * width || length >= max_lightbar_ratio_ * width) continue;
+
+    auto axis = 0.5 * std::atan2(2 * mu11, mu20 - mu02);
+    auto angle_error = std::abs(std::abs(axis) - CV_PI / 2);
+    if (angle_error >= max_angle_error_) continue;
+
+    cv::RotatedRect rotated_rect(
+      cv::Point2f(left + mx, top + my), cv::Size2f(length, width), axis * 180 / CV_PI);
+    auto lightbar = Lightbar(rotated_rect, lightbar_id);
+
+    if (!check_geometry(lightbar)) continue;
+
+    lightbar.color = diff_sum < 0 ? Color::blue : Color::red;
+    lightbars.emplace_back(lightbar);
+    lightbar_id += 1;
+  }
+
+  return lightbars;
+}
+
+void LightbarExtractor::refine_points(Lightbar & lightbar, const cv::Mat & gray_img) const
+{
+  // 配置参数
+  constexpr float ROI_SCALE = 0.07;    // ROI扩展比例
+  constexpr float SEARCH_START = 0.4;  // 搜索起始位置比例
+  constexpr float SEARCH_END = 0.6;    // 搜索结束位置比例
+  constexpr int SAMPLE_LINES = 5;      // 横向采样线数
+  constexpr int SAMPLE_STEPS = 16;     // 每条采样线的步数
+  constexpr int MOMENT_GRID = 32;      // 求矩时每个方向最多的采样点数
+
+  // 扩展并裁剪ROI
+  cv::Rect roi_box = lightbar.rotated_rect.boundingRect();
+  roi_box.x -= roi_box.width * ROI_SCALE;
+  roi_box.y -= roi_box.height * ROI_SCALE;
+  roi_box.width += 2 * roi_box.width * ROI_SCALE;
+  roi_box.height += 2 * roi_box.height * ROI_SCALE;
+  roi_box &= cv::Rect(0, 0, gray_img.cols, gray_img.rows);
+  if (roi_box.empty()) return;
+
+  // 在ROI上按不超过MOMENT_GRID x MOMENT_GRID的网格采样，步长随灯条尺寸增大
+  const int stride_x = (roi_box.width + MOMENT_GRID - 1) / MOMENT_GRID;
+  const int stride_y = (roi_box.height + MOMENT_GRID - 1) / MOMENT_GRID;
+
+  // 一次遍历同时累加不加权和以亮度加权的矩，背景亮度min_val在遍历后再减去
+  int min_val = 255, max_val = 0;
+  double n = 0, sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+  double w = 0, wx = 0, wy = 0, wxx = 0, wyy = 0, wxy = 0;
+  for (int y = stride_y / 2; y < roi_box.height; y += stride_y) {
+    const uchar * row = gray_img.ptr<uchar>(roi_box.y + y) + roi_box.x;
+    for (int x = stride_x / 2; x < roi_box.width; x += stride_x) {
+      const int v = row[x];
+      min_val = std::min(min_val, v);
+      max_val = std::max(max_val, v);
+      n += 1;
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      syy += y * y;
+      sxy += x * y;
+      w += v;
+      wx += v * x;
+      wy += v * y;
+      wxx += v * x * x;
+      wyy += v * y * y;
+      wxy += v * x * y;
+    }
+  }
+  if (max_val <= min_val) return;
+  const auto mean_val = w / n;
+
+  // 以(亮度 - min_val)为权重的矩，与原先减去背景亮度后归一化的质心一致
+  const auto m00 = w - min_val * n;
+  if (m00 <= 0) return;
+  const auto cx = (wx - min_val * sx) / m00;
+  const auto cy = (wy - min_val * sy) / m00;
+  const auto mu20 = (wxx - min_val * sxx) / m00 - cx * cx;
+  const auto mu02 = (wyy - min_val * syy) / m00 - cy * cy;
+  const auto mu11 = (wxy - min_val * sxy) / m00 - cx * cy;
+
+  // 2x2协方差矩阵的主方向即对称轴，无需构造点云做PCA
+  const cv::Point2f centroid(cx + roi_box.x, cy + roi_box.y);
+  const auto theta = 0.5 * std::atan2(2 * mu11, mu20 - mu02);
+  cv::Point2f axis(std::cos(theta), std::sin(theta));
+  if (axis.y > 0) axis = -axis;  // 统一方向
+  const cv::Point2f normal(-axis.y, axis.x);
+
+  // 上下两端各SAMPLE_LINES条采样线，每条SAMPLE_STEPS + 1个点，整体交给remap双线性插值
+  const float start = lightbar.length * SEARCH_START;
+  const float step = lightbar.length * (SEARCH_END - SEARCH_START) / SAMPLE_STEPS;
+  const float half_width = std::max(0.0, (lightbar.width - 2) / 2);
+
+  float map_x[2 * SAMPLE_LINES][SAMPLE_STEPS + 1];
+  float map_y[2 * SAMPLE_LINES][SAMPLE_STEPS + 1];
+  uchar samples[2 * SAMPLE_LINES][SAMPLE_STEPS + 1];
+  for (int row = 0; row < 2 * SAMPLE_LINES; row++) {
+    const float direction = row < SAMPLE_LINES ? 1 : -1;
+    const float offset = half_width * (2.0f * (row % SAMPLE_LINES) / (SAMPLE_LINES - 1) - 1);
+    const auto origin = centroid + axis * direction * start + normal * offset;
+    for (int i = 0; i <= SAMPLE_STEPS; i++) {
+      const auto point = origin + axis * direction * (step * i);
+      map_x[row][i] = point.x;
+      map_y[row][i] = point.y;
+    }
+  }
+
+  cv::Mat map_x_mat(2 * SAMPLE_LINES, SAMPLE_STEPS + 1, CV_32F, map_x);
+  cv::Mat map_y_mat(2 * SAMPLE_LINES, SAMPLE_STEPS + 1, CV_32F, map_y);
+  cv::Mat samples_mat(2 * SAMPLE_LINES, SAMPLE_STEPS + 1, CV_8U, samples);
+  cv::remap(
+    gray_img, samples_mat, map_x_mat, map_y_mat, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+
+  // 每条采样线取最大的亮度下降处，跳变位于相邻两个采样点之间
+  const auto find_corner = [&](int first_row, cv::Point2f & corner) -> bool {
+    cv::Point2f sum(0, 0);
+    int count = 0;
+    for (int row = first_row; row < first_row + SAMPLE_LINES; row++) {
+      int max_diff = 0;
+      int max_index = -1;
+      for (int i = 1; i <= SAMPLE_STEPS; i++) {
+        const int diff = samples[row][i - 1] - samples[row][i];
+        if (diff > max_diff && samples[row][i - 1] > mean_val) {
+          max_diff = diff;
+          max_index = i;
+        }
+      }
+      if (max_index < 0) continue;
+
+      sum.x += 0.5f * (map_x[row][max_index - 1] + map_x[row][max_index]);
+      sum.y += 0.5f * (map_y[row][max_index - 1] + map_y[row][max_index]);
+      count++;
+    }
+
+    if (count == 0) return false;
+    corner = sum / count;
+    return true;
+  };
+
+  find_corner(0, lightbar.top);
+  find_corner(SAMPLE_LINES, lightbar.bottom);
+  lightbar.top2bottom = lightbar.bottom - lightbar.top;
+  lightbar.points = {lightbar.top, lightbar.bottom};
+}
+
+bool LightbarExtractor::check_geometry(const Lightbar & lightbar) const
+{
+  auto angle_ok = lightbar.angle_error < max_angle_error_;
+  auto ratio_ok = lightbar.ratio > min_lightbar_ratio_ && lightbar.ratio < max_lightbar_ratio_;
+  auto length_ok = lightbar.length > min_lightbar_length_;
+  return angle_ok && ratio_ok && length_ok;
+}
+
+Color LightbarExtractor::get_color(
+  const cv::Mat & color_img, const std::vector<cv::Point> & contour) const
+{
+  // color_img中每个像素为(r - b) / 2，求和小于0即蓝色多于红色
+  int diff_sum = 0;
+
+  for (const auto & point : contour) diff_sum += color_img.at<schar>(point);
+
+  return diff_sum < 0 ? Color::blue : Color::red;
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,49 @@
+#ifndef AUTO_AIM__LIGHTBAR_EXTRACTOR_HPP
+#define AUTO_AIM__LIGHTBAR_EXTRACTOR_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "armor.hpp"
+
+namespace auto_aim
+{
+// 从binarize输出的二值图和红蓝差值图中提取灯条
+class LightbarExtractor
+{
+public:
+  explicit LightbarExtractor(const std::string & config_path);
+
+  // 按配置lightbar_extractor选择轮廓法或连通域法
+  std::vector<Lightbar> extract(const cv::Mat & binary_img, const cv::Mat & color_img) const;
+
+  // findContours + minAreaRect
+  std::vector<Lightbar> extract_by_contours(
+    const cv::Mat & binary_img, const cv::Mat & color_img) const;
+
+  // connectedComponentsWithStats + 二阶矩，先用面积和外接框剔除噪点再拟合旋转矩形
+  std::vector<Lightbar> extract_by_components(
+    const cv::Mat & binary_img, const cv::Mat & color_img) const;
+
+  // 沿灯条对称轴搜索亮度跳变，修正top和bottom，未找到跳变的一端保持不变
+  // 对称轴由固定网格上采样的图像矩的协方差求得，求矩与搜索跳变的采样点数均有上限，
+  // 耗时与灯条大小无关
+  // 参考自https://github.com/CSU-FYT-Vision/FYT2024_vision
+  void refine_points(Lightbar & lightbar, const cv::Mat & gray_img) const;
+
+private:
+  bool use_components_;
+
+  double max_angle_error_;
+  double min_lightbar_ratio_, max_lightbar_ratio_;
+  double min_lightbar_length_;
+
+  bool check_geometry(const Lightbar & lightbar) const;
+
+  Color get_color(const cv::Mat & color_img, const std::vector<cv::Point> & contour) const;
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__LIGHTBAR_EXTRACTOR_HPP
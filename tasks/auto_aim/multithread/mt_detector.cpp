@@ -2,99 +2,155 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <optional>
+
+#include "tasks/auto_aim/yolos/infer_pool.hpp"
+#include "tools/math_tools.hpp"
+
 namespace auto_aim
 {
 namespace multithread
 {
 
-MultiThreadDetector::MultiThreadDetector(const std::string & config_path, bool debug)
-: yolo_(config_path, debug)
+namespace
+{
+std::size_t read_infer_requests(const std::string & config_path)
 {
   auto yaml = YAML::LoadFile(config_path);
-  auto yolo_name = yaml["yolo_name"].as<std::string>();
-  auto model_path = yaml[yolo_name + "_model_path"].as<std::string>();
-  device_ = yaml["device"].as<std::string>();
-
-  auto model = core_.read_model(model_path);
-  ov::preprocess::PrePostProcessor ppp(model);
-  auto & input = ppp.input();
-
-  input.tensor()
-    .set_element_type(ov::element::u8)
-    .set_shape({1, 640, 640, 3})  // TODO
-    .set_layout("NHWC")
-    .set_color_format(ov::preprocess::ColorFormat::BGR);
+  auto n = yaml["mt_infer_requests"].IsDefined() ? yaml["mt_infer_requests"].as<int>() : 4;
+  return static_cast<std::size_t>(std::max(n, 2));
+}
+}  // namespace
 
-  input.model().set_layout("NCHW");
+MultiThreadDetector::MultiThreadDetector(const std::string & config_path, bool debug)
+: infer_requests_(read_infer_requests(config_path)), yolo_(config_path, debug, infer_requests_)
+{
+  auto yaml = YAML::LoadFile(config_path);
 
-  input.preprocess()
-    .convert_element_type(ov::element::f32)
-    .convert_color(ov::preprocess::ColorFormat::RGB)
-    // .resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR)
-    .scale(255.0);
+  // 与Tracker判定相机离线的时间间隔相同
+  max_frame_age_ =
+    yaml["mt_max_frame_age"].IsDefined() ? yaml["mt_max_frame_age"].as<double>() : 0.1;
+  format_ = tools::read_pixel_format(yaml);
 
-  model = ppp.build();
-  compiled_model_ = core_.compile_model(
-    model, device_, ov::hint::performance_mode(ov::hint::PerformanceMode::THROUGHPUT));
+  for (std::size_t i = 0; i < infer_requests_; i++) free_.push_back(i);
 
-  tools::logger()->info("[MultiThreadDetector] initialized !");
+  tools::logger()->info(
+    "[MultiThreadDetector] initialized with {} infer requests, max frame age {:.3f}s",
+    infer_requests_, max_frame_age_);
 }
 
 void MultiThreadDetector::push(cv::Mat img, std::chrono::steady_clock::time_point t)
 {
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(img.rows * scale);
-  auto w = static_cast<int>(img.cols * scale);
-
-  // preproces
-  auto input = cv::Mat(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(img, input(roi), {w, h});
-
-  auto input_port = compiled_model_.input();
-  auto infer_request = compiled_model_.create_infer_request();
-  ov::Tensor input_tensor(ov::element::u8, {1, 640, 640, 3}, input.data);
-
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.start_async();
-  queue_.push({img.clone(), t, std::move(infer_request)});
+  if (img.empty()) {
+    tools::logger()->warn("Empty img!, camera drop!");
+    return;
+  }
+
+  std::size_t index;
+  std::optional<std::size_t> oldest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_.empty()) {
+      index = free_.back();
+      free_.pop_back();
+    } else if (!frames_.empty()) {
+      // 最旧的帧让位给新帧
+      index = frames_.front().index;
+      oldest = index;
+      frames_.pop_front();
+    } else {
+      // 所有请求都在pop线程中解码，只可能在mt_infer_requests过小时出现
+      dropped_++;
+      return;
+    }
+  }
+
+  if (oldest) {
+    cancel(*oldest);
+    dropped_++;
+    tools::logger()->debug("[MultiThreadDetector] in-flight window is full, drop the oldest!");
+  }
+
+  // 预处理在调用线程完成，推理由OpenVINO异步执行
+  // 只持有img的引用，相机每帧从FramePool取新缓冲区，不会在解码前覆盖
+  auto frame = Frame{img, t, index, 0, yolo_.roi(img.size())};
+  auto & infer_pool = yolo_.infer_pool();
+  frame.scale = infer_pool.letterbox(frame.index, frame.img(frame.crop));
+  infer_pool.request(frame.index).start_async();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_.emplace_back(std::move(frame));
+  }
+  not_empty_.notify_one();
 }
 
 std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> MultiThreadDetector::pop()
 {
-  auto [img, t, infer_request] = queue_.pop();
-  infer_request.wait();
-
-  // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
-  auto output_shape = output_tensor.get_shape();
-  cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto armors = yolo_.postprocess(scale, output, img, 0);  //暂不支持ROI
-
+  auto [img, armors, t] = decode();
   return {std::move(armors), t};
 }
 
 std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point>
 MultiThreadDetector::debug_pop()
 {
-  auto [img, t, infer_request] = queue_.pop();
-  infer_request.wait();
-
-  // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
-  auto output_shape = output_tensor.get_shape();
-  cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto armors = yolo_.postprocess(scale, output, img, 0);  //暂不支持ROI
-
-  return {img, std::move(armors), t};
+  // 相机输出原始格式时，只有调试显示需要BGR图像
+  auto [img, armors, t] = decode();
+  return {tools::to_bgr(img, format_), std::move(armors), t};
+}
+
+std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point>
+MultiThreadDetector::decode()
+{
+  auto & infer_pool = yolo_.infer_pool();
+
+  while (true) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return !frames_.empty(); });
+      frame = std::move(frames_.front());
+      frames_.pop_front();
+    }
+
+    // 过期的帧不再等待推理结果
+    auto age = tools::delta_time(std::chrono::steady_clock::now(), frame.t);
+    if (age > max_frame_age_) {
+      cancel(frame.index);
+      release(frame.index);
+      stale_++;
+      continue;
+    }
+
+    infer_pool.request(frame.index).wait();
+
+    // 输出张量的视图在请求被复用前有效，解码结束后才归还请求
+    auto output = infer_pool.output(frame.index);
+    auto armors = yolo_.postprocess(frame.scale, output, frame.img, frame_count_++, frame.crop);
+    release(frame.index);
+    completed_++;
+
+    return {frame.img, std::move(armors), frame.t};
+  }
+}
+
+void MultiThreadDetector::cancel(std::size_t index)
+{
+  auto & request = yolo_.infer_pool().request(index);
+  request.cancel();
+
+  // 等待请求真正停止后才能复用
+  try {
+    request.wait();
+  } catch (const ov::Cancelled &) {
+  }
+}
+
+void MultiThreadDetector::release(std::size_t index)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.push_back(index);
 }
 
 }  // namespace multithread
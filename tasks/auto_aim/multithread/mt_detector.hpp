@@ -1,44 +1,86 @@
 #ifndef AUTO_AIM__MT_DETECTOR_HPP
 #define AUTO_AIM__MT_DETECTOR_HPP
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
 #include <opencv2/opencv.hpp>
-#include <openvino/openvino.hpp>
+#include <string>
 #include <tuple>
+#include <vector>
 
-#include "tasks/auto_aim/yolos/yolov5.hpp"
+#include "tasks/auto_aim/armor.hpp"
+#include "tasks/auto_aim/yolo.hpp"
 #include "tools/logger.hpp"
-#include "tools/thread_safe_queue.hpp"
+#include "tools/pixel_format.hpp"
 
 namespace auto_aim
 {
 namespace multithread
 {
 
+// 异步检测流水线：push线程做letterbox并启动推理，pop线程等待推理完成后解码
+// 支持yolo_name配置的任意网络、静态ROI和use_traditional，结果按push的顺序输出
+// yaml中可选：
+//   mt_infer_requests: 同时在途的帧数，默认为4
+//   mt_max_frame_age:  帧从采集到开始解码的最大时长(s)，超过则丢弃，默认为0.1
 class MultiThreadDetector
 {
 public:
+  struct Counters
+  {
+    int completed;  // 完成解码
+    int dropped;    // 在途帧已满时被新帧挤掉
+    int stale;      // 超过mt_max_frame_age被丢弃
+  };
+
   MultiThreadDetector(const std::string & config_path, bool debug = false);
 
+  // 在途帧已满时取消最旧的一帧，新帧总能进入流水线
+  // 不拷贝img，调用者在该帧解码结束前不能改写其数据
   void push(cv::Mat img, std::chrono::steady_clock::time_point t);
 
-  std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> pop();  //暂时不支持yolov8
+  // 跳过过期的帧，阻塞直到有一帧解码完成
+  std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> pop();
 
+  // 返回的图像总是BGR，camera_format为原始格式时在此转换
   std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point> debug_pop();
 
+  Counters counters() const { return {completed_, dropped_, stale_}; }
+
 private:
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
-  std::string device_;
+  struct Frame
+  {
+    cv::Mat img;  // 在解码结束前由流水线持有
+    std::chrono::steady_clock::time_point t;
+    std::size_t index;  // 推理请求的序号
+    double scale;
+    cv::Rect crop;
+  };
+
+  std::size_t infer_requests_;
+  double max_frame_age_;
+  tools::PixelFormat format_;
   YOLO yolo_;
+  int frame_count_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::deque<Frame> frames_;       // 已启动推理、等待解码的帧，按push的顺序排列
+  std::vector<std::size_t> free_;  // 空闲的推理请求
+
+  std::atomic<int> completed_{0}, dropped_{0}, stale_{0};
 
-  tools::ThreadSafeQueue<
-    std::tuple<cv::Mat, std::chrono::steady_clock::time_point, ov::InferRequest>>
-    queue_{16, [] { tools::logger()->debug("[MultiThreadDetector] queue is full!"); }};
+  std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point> decode();
+  void cancel(std::size_t index);
+  void release(std::size_t index);
 };
 
 }  // namespace multithread
 
 }  // namespace auto_aim
 
-#endif  // AUTO_AIM__MT_DETECTOR_HPP
\ No newline at end of file
+#endif  // AUTO_AIM__MT_DETECTOR_HPP
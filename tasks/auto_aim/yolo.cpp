@@ -8,21 +8,31 @@
 
 namespace auto_aim
 {
-YOLO::YOLO(const std::string & config_path, bool debug)
+cv::Rect YOLOBase::roi(const cv::Size & img_size) const
+{
+  if (!use_roi_) return cv::Rect(0, 0, img_size.width, img_size.height);
+
+  auto rect = roi_;
+  if (rect.width == -1) rect.width = img_size.width;     // -1 表示该维度不裁切
+  if (rect.height == -1) rect.height = img_size.height;  // -1 表示该维度不裁切
+  return rect;
+}
+
+YOLO::YOLO(const std::string & config_path, bool debug, std::size_t infer_requests)
 {
   auto yaml = YAML::LoadFile(config_path);
   auto yolo_name = yaml["yolo_name"].as<std::string>();
 
   if (yolo_name == "yolov8") {
-    yolo_ = std::make_unique<YOLOV8>(config_path, debug);
+    yolo_ = std::make_unique<YOLOV8>(config_path, debug, infer_requests);
   }
 
   else if (yolo_name == "yolo11") {
-    yolo_ = std::make_unique<YOLO11>(config_path, debug);
+    yolo_ = std::make_unique<YOLO11>(config_path, debug, infer_requests);
   }
 
   else if (yolo_name == "yolov5") {
-    yolo_ = std::make_unique<YOLOV5>(config_path, debug);
+    yolo_ = std::make_unique<YOLOV5>(config_path, debug, infer_requests);
   }
 
   else {
@@ -35,10 +45,15 @@ std::list<Armor> YOLO::detect(const cv::Mat & img, int frame_count)
   return yolo_->detect(img, frame_count);
 }
 
+std::list<Armor> YOLO::detect(const cv::Mat & img, const cv::Rect & crop, int frame_count)
+{
+  return yolo_->detect(img, crop, frame_count);
+}
+
 std::list<Armor> YOLO::postprocess(
-  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
+  double scale, cv::Mat & output, const cv::Mat & img, int frame_count, const cv::Rect & crop)
 {
-  return yolo_->postprocess(scale, output, bgr_img, frame_count);
+  return yolo_->postprocess(scale, output, img, frame_count, crop);
 }
 
 }  // namespace auto_aim
\ No newline at end of file
@@ -4,27 +4,67 @@
 #include <opencv2/opencv.hpp>
 
 #include "armor.hpp"
+#include "tools/pixel_format.hpp"
 
 namespace auto_aim
 {
+class InferPool;
+
 class YOLOBase
 {
 public:
+  virtual ~YOLOBase() = default;
+
   virtual std::list<Armor> detect(const cv::Mat & img, int frame_count) = 0;
 
+  // 只在img的crop区域上检测，结果为img中的坐标
+  virtual std::list<Armor> detect(const cv::Mat & img, const cv::Rect & crop, int frame_count) = 0;
+
+  // 解码crop区域的推理输出，结果为img中的坐标
+  // img为相机输出的原始格式(camera_format)，需要BGR图像时才转换
   virtual std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count) = 0;
+    double scale, cv::Mat & output, const cv::Mat & img, int frame_count,
+    const cv::Rect & crop) = 0;
+
+  // 异步流水线直接使用的推理请求池
+  virtual InferPool & infer_pool() = 0;
+
+  // yaml中配置的静态ROI，未启用时为整帧
+  cv::Rect roi(const cv::Size & img_size) const;
+
+  // 网络输入边长，取自模型
+  int input_size() const { return input_size_; }
+
+  // 最近一次的推理(含预处理)和解码(含NMS)耗时，单位ms
+  double infer_ms() const { return infer_ms_; }
+  double decode_ms() const { return decode_ms_; }
+
+protected:
+  bool use_roi_ = false;
+  cv::Rect roi_;
+  tools::PixelFormat format_ = tools::PixelFormat::bgr;
+  int input_size_ = 0;
+  double infer_ms_ = 0, decode_ms_ = 0;
 };
 
 class YOLO
 {
 public:
-  YOLO(const std::string & config_path, bool debug = true);
+  YOLO(const std::string & config_path, bool debug = true, std::size_t infer_requests = 1);
 
   std::list<Armor> detect(const cv::Mat & img, int frame_count = -1);
 
+  std::list<Armor> detect(const cv::Mat & img, const cv::Rect & crop, int frame_count = -1);
+
   std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count);
+    double scale, cv::Mat & output, const cv::Mat & img, int frame_count,
+    const cv::Rect & crop);
+
+  InferPool & infer_pool() { return yolo_->infer_pool(); }
+  cv::Rect roi(const cv::Size & img_size) const { return yolo_->roi(img_size); }
+  int input_size() const { return yolo_->input_size(); }
+  double infer_ms() const { return yolo_->infer_ms(); }
+  double decode_ms() const { return yolo_->decode_ms(); }
 
 private:
   std::unique_ptr<YOLOBase> yolo_;
@@ -0,0 +1,213 @@
+#ifndef AUTO_AIM__HEAD_DECODER_HPP
+#define AUTO_AIM__HEAD_DECODER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <openvino/openvino.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tasks/auto_aim/yolos/score_filter.hpp"
+#include "tasks/auto_aim/yolos/small_nms.hpp"
+
+namespace auto_aim
+{
+// yolov5: [1, anchor_num, 2 * 4 + 1 + 4 + class_num]，每行一个anchor
+//         4个角点 + objectness(logit) + 4个颜色 + 各类别，框为角点的外接矩形
+struct V5Layout
+{
+  static constexpr bool CHANNEL_FIRST = false;
+  static constexpr int KEYPOINT_NUM = 4;
+  static constexpr int COLOR_NUM = 4;
+  static constexpr int FIXED_CHANNELS = 2 * KEYPOINT_NUM + 1 + COLOR_NUM;
+};
+
+// yolov8/yolo11/能量机关: [1, 4 + class_num + 2 * N, anchor_num]，每列一个anchor
+//                        xywh + 各类别 + N个关键点，分数为各类别的最大值
+template <int N>
+struct AnchorFreeLayout
+{
+  static constexpr bool CHANNEL_FIRST = true;
+  static constexpr int KEYPOINT_NUM = N;
+  static constexpr int COLOR_NUM = 0;
+  static constexpr int FIXED_CHANNELS = 4 + 2 * KEYPOINT_NUM;
+};
+
+using ArmorLayout = AnchorFreeLayout<4>;  // 装甲板4个角点
+using BuffLayout = AnchorFreeLayout<6>;   // 能量机关6个关键点
+
+template <int N>
+struct HeadDetection
+{
+  int class_id = 0;
+  int color_id = 0;  // 仅V5Layout有效
+  float score;
+  cv::Rect box;
+  std::array<cv::Point2f, N> keypoints;  // 已换算回letterbox前的图像坐标
+};
+
+// 按输出排布在编译期特化的解码器：分数预筛 + 只解码通过的anchor + NMS
+// 类别数由模型输出的通道数减去排布固定的通道数得到，换模型无需改代码
+template <class Layout>
+class HeadDecoder
+{
+public:
+  using Detection = HeadDetection<Layout::KEYPOINT_NUM>;
+
+  HeadDecoder(const ov::Shape & output_shape, float score_threshold, const NmsParams & nms_params)
+  : score_threshold_(score_threshold), nms_(nms_params)
+  {
+    if (output_shape.size() != 3)
+      throw std::runtime_error("Unexpected output rank: " + std::to_string(output_shape.size()));
+
+    channel_num_ = static_cast<int>(Layout::CHANNEL_FIRST ? output_shape[1] : output_shape[2]);
+    anchor_num_ = static_cast<int>(Layout::CHANNEL_FIRST ? output_shape[2] : output_shape[1]);
+    class_num_ = channel_num_ - Layout::FIXED_CHANNELS;
+    if (class_num_ < 1)
+      throw std::runtime_error(
+        "Output with " + std::to_string(channel_num_) + " channels does not match head layout!");
+
+    // 预留足够的容量，运行时不再申请内存
+    candidates_.reserve(anchor_num_);
+    results_.reserve(nms_params.max_detections);
+  }
+
+  int class_num() const { return class_num_; }
+  int anchor_num() const { return anchor_num_; }
+
+  // output为输出张量的二维视图，scale为letterbox的缩放比例
+  // 返回按分数从高到低排列的结果，在下次decode前有效
+  const std::vector<Detection> & decode(const cv::Mat & output, double scale)
+  {
+    candidates_.clear();
+    if constexpr (Layout::CHANNEL_FIRST) {
+      filter_max_scores(
+        output.ptr<float>(4), class_num_, output.step1(), anchor_num_, score_threshold_,
+        candidates_);
+    } else {
+      // objectness为logit，先与阈值的logit比较，通过的anchor再做sigmoid
+      auto logit_threshold = std::log(score_threshold_ / (1 - score_threshold_));
+      filter_scores(
+        output.ptr<float>() + 2 * Layout::KEYPOINT_NUM, anchor_num_, output.step1(),
+        logit_threshold, candidates_);
+    }
+
+    nms_.clear();
+    for (auto anchor : candidates_) {
+      Detection d;
+      if (!decode_anchor(output, anchor, scale, d)) continue;
+      nms_.push(d.box, d.score, d.class_id, d.color_id, d.keypoints);
+    }
+    nms_.run();
+
+    results_.clear();
+    for (int k = 0; k < nms_.kept_num(); k++) {
+      auto i = nms_.kept(k);
+      results_.push_back(
+        {nms_.class_id(i), nms_.color_id(i), nms_.score(i), nms_.box(i), nms_.keypoints(i)});
+    }
+    return results_;
+  }
+
+private:
+  float score_threshold_;
+  int channel_num_, anchor_num_, class_num_;
+
+  // 以下缓冲区逐帧复用
+  std::vector<int> candidates_;
+  SmallNms<Layout::KEYPOINT_NUM> nms_;
+  std::vector<Detection> results_;
+
+  bool decode_anchor(const cv::Mat & output, int anchor, double scale, Detection & detection) const
+  {
+    if constexpr (Layout::CHANNEL_FIRST) {
+      auto at = [&output, anchor](int channel) { return output.ptr<float>(channel)[anchor]; };
+
+      // 与minMaxLoc相同，分数相等时取第一个类别
+      detection.score = at(4);
+      for (int i = 1; i < class_num_; i++) {
+        if (at(4 + i) <= detection.score) continue;
+        detection.score = at(4 + i);
+        detection.class_id = i;
+      }
+
+      auto x = at(0);
+      auto y = at(1);
+      auto w = at(2);
+      auto h = at(3);
+      detection.box = cv::Rect(
+        static_cast<int>((x - 0.5 * w) / scale), static_cast<int>((y - 0.5 * h) / scale),
+        static_cast<int>(w / scale), static_cast<int>(h / scale));
+
+      auto offset = 4 + class_num_;
+      for (int i = 0; i < Layout::KEYPOINT_NUM; i++) {
+        auto x = at(offset + 2 * i) / scale;
+        auto y = at(offset + 2 * i + 1) / scale;
+        detection.keypoints[i] = cv::Point2f(x, y);
+      }
+    } else {
+      const auto * row = output.ptr<float>(anchor);
+      const auto * score = row + 2 * Layout::KEYPOINT_NUM;
+      const auto * colors = score + 1;
+      const auto * classes = colors + Layout::COLOR_NUM;
+
+      detection.score = static_cast<float>(1.0 / (1.0 + std::exp(-*score)));
+      if (detection.score < score_threshold_) return false;
+
+      detection.color_id = static_cast<int>(std::max_element(colors, classes) - colors);
+      detection.class_id =
+        static_cast<int>(std::max_element(classes, classes + class_num_) - classes);
+
+      // 角点依次为左上、左下、右下、右上，转换为左上、右上、右下、左下
+      constexpr int ORDER[4] = {0, 3, 2, 1};
+      for (int i = 0; i < 4; i++) {
+        auto x = row[2 * ORDER[i]] / scale;
+        auto y = row[2 * ORDER[i] + 1] / scale;
+        detection.keypoints[i] = cv::Point2f(x, y);
+      }
+
+      auto [min_x, max_x] = std::minmax(
+        {detection.keypoints[0].x, detection.keypoints[1].x, detection.keypoints[2].x,
+         detection.keypoints[3].x});
+      auto [min_y, max_y] = std::minmax(
+        {detection.keypoints[0].y, detection.keypoints[1].y, detection.keypoints[2].y,
+         detection.keypoints[3].y});
+      detection.box = cv::Rect(min_x, min_y, max_x - min_x, max_y - min_y);
+    }
+
+    return true;
+  }
+};
+
+// 装甲板4个角点按左上、右上、右下、左下排序
+inline void sort_keypoints(std::vector<cv::Point2f> & keypoints)
+{
+  if (keypoints.size() != 4) return;
+
+  std::sort(keypoints.begin(), keypoints.end(), [](const cv::Point2f & a, const cv::Point2f & b) {
+    return a.y < b.y;
+  });
+
+  std::vector<cv::Point2f> top_points = {keypoints[0], keypoints[1]};
+  std::vector<cv::Point2f> bottom_points = {keypoints[2], keypoints[3]};
+
+  std::sort(top_points.begin(), top_points.end(), [](const cv::Point2f & a, const cv::Point2f & b) {
+    return a.x < b.x;
+  });
+
+  std::sort(
+    bottom_points.begin(), bottom_points.end(),
+    [](const cv::Point2f & a, const cv::Point2f & b) { return a.x < b.x; });
+
+  keypoints[0] = top_points[0];     // top-left
+  keypoints[1] = top_points[1];     // top-right
+  keypoints[2] = bottom_points[1];  // bottom-right
+  keypoints[3] = bottom_points[0];  // bottom-left
+}
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__HEAD_DECODER_HPP
@@ -0,0 +1,199 @@
+#include "infer_pool.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+
+#include "tools/logger.hpp"
+
+namespace auto_aim
+{
+InferPool::InferPool(
+  const std::string & config_path, const std::string & model_key, std::size_t size,
+  ov::hint::PerformanceMode mode, std::optional<Preprocess> preprocess)
+: mode_(mode)
+{
+  auto yaml = YAML::LoadFile(config_path);
+  auto model_path = yaml[model_key].as<std::string>();
+  device_ = yaml["device"].as<std::string>();
+
+  if (preprocess) {
+    preprocess_ = *preprocess;
+  } else {
+    // 未配置时沿用cpu预处理
+    auto name = yaml["infer_preprocess"].IsDefined() ? yaml["infer_preprocess"].as<std::string>()
+                                                     : "cpu";
+    if (name == "cpu")
+      preprocess_ = Preprocess::cpu;
+    else if (name == "ov")
+      preprocess_ = Preprocess::ov;
+    else
+      throw std::runtime_error("Unknown infer_preprocess: " + name + "!");
+  }
+
+  format_ = tools::read_pixel_format(yaml);
+  if (tools::is_bayer(format_) && preprocess_ == Preprocess::ov)
+    throw std::runtime_error("Bayer camera_format requires cpu infer_preprocess!");
+
+  model_ = core_.read_model(model_path);
+
+  // 输入为方形的NCHW张量
+  auto input_shape = model_->input().get_partial_shape();
+  if (input_shape.rank().get_length() != 4 || input_shape[2].is_dynamic())
+    throw std::runtime_error("Model input must be static NCHW: " + model_path + "!");
+  input_size_ = static_cast<int>(input_shape[2].get_length());
+
+  slots_.resize(std::max<std::size_t>(1, size));
+
+  tools::logger()->info(
+    "[InferPool] {} on {}, {} request(s), input {}x{}, {} preprocess", model_path, device_,
+    slots_.size(), input_size_, input_size_, preprocess_ == Preprocess::cpu ? "cpu" : "ov");
+
+  // ov模式在第一帧确定输入尺寸后再编译
+  if (preprocess_ == Preprocess::ov) return;
+
+  auto model = build({input_size_, input_size_});
+  compiled_model_ = core_.compile_model(model, device_, ov::hint::performance_mode(mode_));
+
+  // 预分配全部输入张量并与请求绑定，运行时不再申请内存
+  for (auto & slot : slots_) {
+    slot.request = compiled_model_.create_infer_request();
+    slot.input_tensor = ov::Tensor(ov::element::u8, compiled_model_.input().get_shape());
+    slot.input = cv::Mat(input_size_, input_size_, CV_8UC3, slot.input_tensor.data());
+    slot.input.setTo(cv::Scalar(0, 0, 0));
+    slot.content = {0, 0};
+    slot.request.set_input_tensor(slot.input_tensor);
+  }
+}
+
+std::size_t InferPool::next()
+{
+  auto index = next_;
+  next_ = (next_ + 1) % slots_.size();
+  return index;
+}
+
+double InferPool::letterbox(std::size_t index, const cv::Mat & img)
+{
+  auto & slot = slots_[index];
+  auto scale = get_scale(img.size());
+
+  if (preprocess_ == Preprocess::ov) {
+    slot.request = get_graph(img.size()).requests[index];
+
+    // 按Mat的行步长包装，ROI视图同样无需拷贝
+    auto rows = static_cast<std::size_t>(img.rows);
+    auto cols = static_cast<std::size_t>(img.cols);
+    auto step = static_cast<std::size_t>(img.step[0]);
+    ov::Tensor input_tensor(
+      ov::element::u8, {1, rows, cols, 3}, img.data, {rows * step, step, 3, 1});
+    slot.request.set_input_tensor(input_tensor);
+    return scale;
+  }
+
+  auto h = static_cast<int>(img.rows * scale);
+  auto w = static_cast<int>(img.cols * scale);
+
+  // 只清零上一帧图像超出本帧图像的部分，其余填充区域一直为0
+  auto & last = slot.content;
+  if (last.width > w) {
+    slot.input(cv::Rect(w, 0, last.width - w, last.height)).setTo(0);
+  }
+  if (last.height > h) {
+    slot.input(cv::Rect(0, h, std::min(w, last.width), last.height - h)).setTo(0);
+  }
+  last = {w, h};
+
+  // dst尺寸与类型一致，resize直接写入张量内存
+  auto roi = slot.input(cv::Rect(0, 0, w, h));
+  if (tools::is_bayer(format_))
+    tools::bayer_resize(img, format_, roi);
+  else
+    cv::resize(img, roi, {w, h});
+
+  return scale;
+}
+
+cv::Mat InferPool::output(std::size_t index)
+{
+  auto output_tensor = slots_[index].request.get_output_tensor();
+  auto output_shape = output_tensor.get_shape();
+  return cv::Mat(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
+}
+
+cv::Mat InferPool::infer(const cv::Mat & img, double & scale)
+{
+  auto index = next();
+  scale = letterbox(index, img);
+  slots_[index].request.infer();
+  return output(index);
+}
+
+double InferPool::get_scale(const cv::Size & img_size) const
+{
+  auto x_scale = static_cast<double>(input_size_) / img_size.height;
+  auto y_scale = static_cast<double>(input_size_) / img_size.width;
+  return std::min(x_scale, y_scale);
+}
+
+std::shared_ptr<ov::Model> InferPool::build(const cv::Size & img_size) const
+{
+  auto height = static_cast<std::size_t>(img_size.height);
+  auto width = static_cast<std::size_t>(img_size.width);
+
+  ov::preprocess::PrePostProcessor ppp(model_->clone());
+  auto & input = ppp.input();
+
+  input.tensor()
+    .set_element_type(ov::element::u8)
+    .set_shape({1, height, width, 3})
+    .set_layout("NHWC")
+    .set_color_format(
+      format_ == tools::PixelFormat::rgb ? ov::preprocess::ColorFormat::RGB
+                                         : ov::preprocess::ColorFormat::BGR);
+
+  input.model().set_layout("NCHW");
+
+  auto & preprocess = input.preprocess();
+  preprocess.convert_element_type(ov::element::f32)
+    .convert_color(ov::preprocess::ColorFormat::RGB);
+
+  if (preprocess_ == Preprocess::ov) {
+    // 与cpu模式相同的letterbox：等比缩放后在右侧和下方补0，此时仍为NHWC排布
+    auto scale = get_scale(img_size);
+    auto h = static_cast<int>(img_size.height * scale);
+    auto w = static_cast<int>(img_size.width * scale);
+    preprocess.resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR, h, w)
+      .pad(
+        {0, 0, 0, 0}, {0, input_size_ - h, input_size_ - w, 0}, 0,
+        ov::preprocess::PaddingMode::CONSTANT);
+  }
+
+  preprocess.scale(255.0);
+
+  return ppp.build();
+}
+
+InferPool::Graph & InferPool::get_graph(const cv::Size & img_size)
+{
+  auto key = std::make_pair(img_size.width, img_size.height);
+  auto it = graphs_.find(key);
+  if (it != graphs_.end()) return it->second;
+
+  auto start = std::chrono::steady_clock::now();
+
+  Graph graph;
+  auto model = build(img_size);
+  graph.compiled_model = core_.compile_model(model, device_, ov::hint::performance_mode(mode_));
+  for (std::size_t i = 0; i < slots_.size(); i++)
+    graph.requests.emplace_back(graph.compiled_model.create_infer_request());
+
+  auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+  tools::logger()->info(
+    "[InferPool] Compiled for {}x{} input in {:.0f}ms", img_size.width, img_size.height,
+    ms.count());
+
+  return graphs_.emplace(key, std::move(graph)).first->second;
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,102 @@
+#ifndef AUTO_AIM__INFER_POOL_HPP
+#define AUTO_AIM__INFER_POOL_HPP
+
+#include <map>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <openvino/openvino.hpp>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tools/pixel_format.hpp"
+
+namespace auto_aim
+{
+// 可复用的推理请求池，yaml中infer_preprocess可选：
+//   cpu: 每个请求在构造时绑定一块预分配的u8 NHWC BGR输入张量，
+//        letterbox直接写入张量内存，只清零上一帧图像占用而本帧变为填充的区域
+//   ov:  缩放和填充编译进推理图，图像(或其ROI视图)按步长零拷贝包装为输入张量，
+//        每种输入尺寸在第一次出现时编译一次
+// 图像的像素格式取自yaml中的camera_format：
+//   rgb:   输入张量声明为RGB，省去两次通道交换
+//   bayer: 仅支持cpu预处理，去马赛克与缩放合并为一步(tools::bayer_resize)
+class InferPool
+{
+public:
+  enum class Preprocess
+  {
+    cpu,
+    ov
+  };
+
+  // 模型路径取自yaml中的model_key，网络输入尺寸读取自模型的NCHW输入
+  // preprocess未指定时读取yaml中的infer_preprocess
+  InferPool(
+    const std::string & config_path, const std::string & model_key, std::size_t size = 1,
+    ov::hint::PerformanceMode mode = ov::hint::PerformanceMode::LATENCY,
+    std::optional<Preprocess> preprocess = std::nullopt);
+
+  int input_size() const { return input_size_; }
+  std::size_t size() const { return slots_.size(); }
+
+  // 模型原始输出的形状，与预处理方式无关
+  ov::Shape output_shape() const { return model_->output().get_shape(); }
+
+  // 轮流取出下一个请求的序号
+  std::size_t next();
+
+  // 为index号请求准备输入，返回缩放比例
+  // ov模式下不拷贝图像，img在该请求推理结束前必须保持有效且不被修改
+  double letterbox(std::size_t index, const cv::Mat & img);
+
+  ov::InferRequest & request(std::size_t index) { return slots_[index].request; }
+
+  // index号请求输出张量的二维视图，在该请求下次推理前有效
+  cv::Mat output(std::size_t index);
+
+  // 同步推理：letterbox + infer，返回输出张量的视图
+  cv::Mat infer(const cv::Mat & img, double & scale);
+
+  // cpu模式下的编译模型
+  const ov::CompiledModel & compiled_model() const { return compiled_model_; }
+
+private:
+  struct Slot
+  {
+    ov::InferRequest request;
+    ov::Tensor input_tensor;
+    cv::Mat input;     // input_tensor内存的视图
+    cv::Size content;  // 上一帧图像在input中占用的区域
+  };
+
+  // ov模式下某一输入尺寸对应的推理图
+  struct Graph
+  {
+    ov::CompiledModel compiled_model;
+    std::vector<ov::InferRequest> requests;
+  };
+
+  ov::Core core_;
+  std::string device_;
+  ov::hint::PerformanceMode mode_;
+  Preprocess preprocess_;
+  tools::PixelFormat format_;
+  int input_size_;
+
+  std::shared_ptr<ov::Model> model_;
+  ov::CompiledModel compiled_model_;
+  std::map<std::pair<int, int>, Graph> graphs_;
+
+  std::vector<Slot> slots_;
+  std::size_t next_ = 0;
+
+  double get_scale(const cv::Size & img_size) const;
+  std::shared_ptr<ov::Model> build(const cv::Size & img_size) const;
+  Graph & get_graph(const cv::Size & img_size);
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__INFER_POOL_HPP
@@ -0,0 +1,103 @@
+#include "score_filter.hpp"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUTO_AIM_SCORE_FILTER_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUTO_AIM_SCORE_FILTER_SSE2
+#endif
+
+namespace auto_aim
+{
+namespace
+{
+// 4个anchor的比较结果，第k位为1表示第k个通过
+inline void push_mask(int mask, int base, std::vector<int> & indices)
+{
+  while (mask) {
+    auto k = __builtin_ctz(mask);
+    indices.push_back(base + k);
+    mask &= mask - 1;
+  }
+}
+
+#if defined(AUTO_AIM_SCORE_FILTER_NEON)
+inline int movemask(uint32x4_t v)
+{
+  return (vgetq_lane_u32(v, 0) & 1) | (vgetq_lane_u32(v, 1) & 2) | (vgetq_lane_u32(v, 2) & 4) |
+         (vgetq_lane_u32(v, 3) & 8);
+}
+#endif
+}  // namespace
+
+void filter_scores(
+  const float * scores, int count, std::size_t stride, float threshold, std::vector<int> & indices)
+{
+  int i = 0;
+
+#if defined(AUTO_AIM_SCORE_FILTER_NEON)
+  const auto t = vdupq_n_f32(threshold);
+  for (; i + 4 <= count; i += 4) {
+    const auto * p = scores + i * stride;
+    float32x4_t v;
+    if (stride == 1) {
+      v = vld1q_f32(p);
+    } else {
+      v = vdupq_n_f32(p[0]);
+      v = vsetq_lane_f32(p[stride], v, 1);
+      v = vsetq_lane_f32(p[2 * stride], v, 2);
+      v = vsetq_lane_f32(p[3 * stride], v, 3);
+    }
+    push_mask(movemask(vcgeq_f32(v, t)), i, indices);
+  }
+#elif defined(AUTO_AIM_SCORE_FILTER_SSE2)
+  const auto t = _mm_set1_ps(threshold);
+  for (; i + 4 <= count; i += 4) {
+    const auto * p = scores + i * stride;
+    auto v = stride == 1 ? _mm_loadu_ps(p)
+                         : _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]);
+    push_mask(_mm_movemask_ps(_mm_cmpge_ps(v, t)), i, indices);
+  }
+#endif
+
+  for (; i < count; i++)
+    if (scores[i * stride] >= threshold) indices.push_back(i);
+}
+
+void filter_max_scores(
+  const float * planes, int plane_num, std::size_t plane_step, int count, float threshold,
+  std::vector<int> & indices)
+{
+  int i = 0;
+
+#if defined(AUTO_AIM_SCORE_FILTER_NEON)
+  const auto t = vdupq_n_f32(threshold);
+  for (; i + 4 <= count; i += 4) {
+    auto v = vld1q_f32(planes + i);
+    for (int c = 1; c < plane_num; c++) {
+      v = vmaxq_f32(v, vld1q_f32(planes + c * plane_step + i));
+    }
+    push_mask(movemask(vcgeq_f32(v, t)), i, indices);
+  }
+#elif defined(AUTO_AIM_SCORE_FILTER_SSE2)
+  const auto t = _mm_set1_ps(threshold);
+  for (; i + 4 <= count; i += 4) {
+    auto v = _mm_loadu_ps(planes + i);
+    for (int c = 1; c < plane_num; c++) {
+      v = _mm_max_ps(v, _mm_loadu_ps(planes + c * plane_step + i));
+    }
+    push_mask(_mm_movemask_ps(_mm_cmpge_ps(v, t)), i, indices);
+  }
+#endif
+
+  for (; i < count; i++) {
+    auto score = planes[i];
+    for (int c = 1; c < plane_num; c++) score = std::max(score, planes[c * plane_step + i]);
+    if (score >= threshold) indices.push_back(i);
+  }
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,24 @@
+#ifndef AUTO_AIM__SCORE_FILTER_HPP
+#define AUTO_AIM__SCORE_FILTER_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace auto_aim
+{
+// 在模型输出的原始排布上筛选分数，只把通过阈值的anchor下标追加到indices
+// x86使用SSE2，ARM使用NEON，每次比较4个anchor
+
+// scores[i * stride] >= threshold的i，0 <= i < count
+void filter_scores(
+  const float * scores, int count, std::size_t stride, float threshold, std::vector<int> & indices);
+
+// 类别分数按平面存放：第c类第i个anchor的分数为planes[c * plane_step + i]
+// 逐anchor取各类别的最大值后与threshold比较
+void filter_max_scores(
+  const float * planes, int plane_num, std::size_t plane_step, int count, float threshold,
+  std::vector<int> & indices);
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__SCORE_FILTER_HPP
@@ -0,0 +1,136 @@
+#ifndef AUTO_AIM__SMALL_NMS_HPP
+#define AUTO_AIM__SMALL_NMS_HPP
+
+#include <algorithm>
+#include <array>
+#include <opencv2/opencv.hpp>
+
+namespace auto_aim
+{
+struct NmsParams
+{
+  float iou_threshold;
+  float merge_threshold = 0.7f;  // 被抑制且IoU大于该值的候选，其关键点按分数加权并入保留框
+  int max_detections = 32;       // 保留框达到该数量后提前结束
+  bool class_aware = false;      // 只在同类别的框之间抑制
+};
+
+// 面向几十个候选的NMS：候选按列存放在固定容量的数组中，运行时不申请内存
+// 用堆按分数从高到低逐个取出候选，只与已保留的框比较，结果与cv::dnn::NMSBoxes一致
+template <int KEYPOINT_NUM, int CAPACITY = 256>
+class SmallNms
+{
+public:
+  using Keypoints = std::array<cv::Point2f, KEYPOINT_NUM>;
+
+  explicit SmallNms(const NmsParams & params) : params_(params) {}
+
+  void clear()
+  {
+    size_ = 0;
+    kept_num_ = 0;
+  }
+
+  int size() const { return size_; }
+
+  // 容量已满时替换分数最低的候选
+  void push(
+    const cv::Rect & box, float score, int class_id, int color_id, const Keypoints & keypoints)
+  {
+    auto i = size_;
+    if (size_ < CAPACITY) {
+      size_++;
+    } else {
+      i = static_cast<int>(std::min_element(scores_.begin(), scores_.end()) - scores_.begin());
+      if (scores_[i] >= score) return;
+    }
+
+    boxes_[i] = box;
+    scores_[i] = score;
+    class_ids_[i] = class_id;
+    color_ids_[i] = color_id;
+    keypoints_[i] = keypoints;
+  }
+
+  void run()
+  {
+    // 分数相同时序号小的优先，与NMSBoxes的稳定排序一致
+    auto higher = [this](int a, int b) {
+      return scores_[a] != scores_[b] ? scores_[a] < scores_[b] : a > b;
+    };
+
+    for (int i = 0; i < size_; i++) order_[i] = i;
+    std::make_heap(order_.begin(), order_.begin() + size_, higher);
+
+    kept_num_ = 0;
+    for (auto end = size_; end > 0 && kept_num_ < params_.max_detections;) {
+      std::pop_heap(order_.begin(), order_.begin() + end, higher);
+      auto i = order_[--end];
+
+      auto suppressed = false;
+      for (int k = 0; k < kept_num_ && !suppressed; k++) {
+        auto j = kept_[k];
+        if (params_.class_aware && class_ids_[i] != class_ids_[j]) continue;
+
+        auto iou = get_iou(boxes_[i], boxes_[j]);
+        if (iou <= params_.iou_threshold) continue;
+
+        suppressed = true;
+        if (iou <= params_.merge_threshold) continue;
+
+        weights_[k] += scores_[i];
+        for (int p = 0; p < KEYPOINT_NUM; p++) sums_[k][p] += keypoints_[i][p] * scores_[i];
+      }
+      if (suppressed) continue;
+
+      kept_[kept_num_] = i;
+      weights_[kept_num_] = scores_[i];
+      for (int p = 0; p < KEYPOINT_NUM; p++) sums_[kept_num_][p] = keypoints_[i][p] * scores_[i];
+      kept_num_++;
+    }
+
+    // 只有合并过的框才重新计算关键点，避免未合并时的舍入误差
+    for (int k = 0; k < kept_num_; k++) {
+      auto i = kept_[k];
+      if (weights_[k] <= scores_[i]) continue;
+      for (int p = 0; p < KEYPOINT_NUM; p++) keypoints_[i][p] = sums_[k][p] / weights_[k];
+    }
+  }
+
+  // run之后保留的候选数，以及第k个(按分数从高到低)保留候选的序号
+  int kept_num() const { return kept_num_; }
+  int kept(int k) const { return kept_[k]; }
+
+  const cv::Rect & box(int i) const { return boxes_[i]; }
+  float score(int i) const { return scores_[i]; }
+  int class_id(int i) const { return class_ids_[i]; }
+  int color_id(int i) const { return color_ids_[i]; }
+  const Keypoints & keypoints(int i) const { return keypoints_[i]; }
+
+private:
+  NmsParams params_;
+  int size_ = 0;
+  int kept_num_ = 0;
+
+  std::array<cv::Rect, CAPACITY> boxes_;
+  std::array<float, CAPACITY> scores_;
+  std::array<int, CAPACITY> class_ids_;
+  std::array<int, CAPACITY> color_ids_;
+  std::array<Keypoints, CAPACITY> keypoints_;
+
+  std::array<int, CAPACITY> order_;
+  std::array<int, CAPACITY> kept_;
+  std::array<float, CAPACITY> weights_;
+  std::array<Keypoints, CAPACITY> sums_;
+
+  static float get_iou(const cv::Rect & a, const cv::Rect & b)
+  {
+    auto intersection = static_cast<float>((a & b).area());
+    auto union_area = static_cast<float>(a.area() + b.area()) - intersection;
+    return union_area > 0 ? intersection / union_area : 0;
+  }
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__SMALL_NMS_HPP
@@ -10,48 +10,54 @@
 #include "tasks/auto_aim/armor.hpp"
 #include "tasks/auto_aim/detector.hpp"
 #include "tasks/auto_aim/yolo.hpp"
+#include "tasks/auto_aim/yolos/head_decoder.hpp"
+#include "tasks/auto_aim/yolos/infer_pool.hpp"
+#include "tools/debug_sink.hpp"
 
 namespace auto_aim
 {
 class YOLO11 : public YOLOBase
 {
 public:
-  YOLO11(const std::string & config_path, bool debug);
+  // infer_requests大于1时以吞吐量模式编译，供异步流水线轮流使用
+  YOLO11(const std::string & config_path, bool debug, std::size_t infer_requests = 1);
 
   std::list<Armor> detect(const cv::Mat & bgr_img, int frame_count) override;
 
+  std::list<Armor> detect(const cv::Mat & img, const cv::Rect & crop, int frame_count) override;
+
   std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count) override;
+    double scale, cv::Mat & output, const cv::Mat & img, int frame_count,
+    const cv::Rect & crop) override;
+
+  InferPool & infer_pool() override { return infer_pool_; }
 
 private:
-  std::string device_, model_path_;
-  std::string save_path_, debug_path_;
-  bool debug_, use_roi_;
+  std::string debug_path_;
+  bool debug_, use_traditional_;
 
-  const int class_num_ = 38;
   const float nms_threshold_ = 0.3;
   const float score_threshold_ = 0.7;
   double min_confidence_, binary_threshold_;
 
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
+  InferPool infer_pool_;
+  HeadDecoder<ArmorLayout> decoder_;  // 类别数取自模型输出
 
-  cv::Rect roi_;
-  cv::Point2f offset_;
   cv::Mat tmp_img_;
 
   Detector detector_;
+  tools::DebugSink & debug_sink_;
 
   bool check_name(const Armor & armor) const;
   bool check_type(const Armor & armor) const;
 
-  cv::Point2f get_center_norm(const cv::Mat & bgr_img, const cv::Point2f & center) const;
-
-  std::list<Armor> parse(double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count);
+  cv::Point2f get_center_norm(const cv::Mat & img, const cv::Point2f & center) const;
 
   void save(const Armor & armor) const;
-  void draw_detections(const cv::Mat & img, const std::list<Armor> & armors, int frame_count) const;
-  void sort_keypoints(std::vector<cv::Point2f> & keypoints);
+  // img为相机原始格式，只在需要输出时转换为BGR
+  void draw_detections(
+    const cv::Mat & img, const std::list<Armor> & armors, int frame_count,
+    const cv::Rect & crop) const;
 };
 
 }  // namespace auto_aim
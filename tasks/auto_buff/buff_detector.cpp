@@ -4,7 +4,10 @@
 
 namespace auto_buff
 {
-Buff_Detector::Buff_Detector(const std::string & config) : status_(LOSE), lose_(0), MODE_(config) {}
+Buff_Detector::Buff_Detector(const std::string & config, bool debug)
+: status_(LOSE), lose_(0), MODE_(config, debug)
+{
+}
 
 void Buff_Detector::handle_img(const cv::Mat & bgr_img, cv::Mat & dilated_img)
 {
@@ -15,7 +15,7 @@ namespace auto_buff
 class Buff_Detector
 {
 public:
-  Buff_Detector(const std::string & config);
+  Buff_Detector(const std::string & config, bool debug = false);
 
   std::optional<PowerRune> detect_24(cv::Mat & bgr_img);
 
@@ -3,9 +3,12 @@
 #include <yaml-cpp/yaml.h>
 
 #include <filesystem>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 
+#include "tasks/auto_aim/yolos/head_decoder.hpp"
+#include "tools/debug_sink.hpp"
 #include "tools/logger.hpp"
 
 namespace auto_buff
@@ -23,7 +26,8 @@ public:
     std::vector<cv::Point2f> kpt;
   };
 
-  YOLO11_BUFF(const std::string & config);
+  // debug为true时在image上绘制检测结果并输出到debug_sink
+  YOLO11_BUFF(const std::string & config, bool debug = false);
 
   // 使用NMS，用来获取多个框
   std::vector<Object> get_multicandidateboxes(cv::Mat & image);
@@ -38,6 +42,12 @@ private:
   ov::InferRequest infer_request;
   ov::Tensor input_tensor;
   const int NUM_POINTS = 6;
+  std::unique_ptr<auto_aim::HeadDecoder<auto_aim::BuffLayout>> decoder;  // 类别数取自模型输出
+  bool debug_;
+  tools::DebugSink & debug_sink_;
+
+  // 解码并NMS，结果按置信度从高到低排列
+  std::vector<Object> decode(float factor);
 
   // 转换图像数据: 先转换元素类型, (可选)然后归一化到[0, 1], (可选)然后交换RB通道
   void convert(
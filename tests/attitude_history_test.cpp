@@ -0,0 +1,215 @@
+#include <fmt/core.h>
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "tools/attitude_history.hpp"
+#include "tools/logger.hpp"
+
+// AttitudeHistory的正确性与多线程压力测试：
+// 一个写线程以固定角速度写入姿态，多个读线程并发查询过去、当前和未来的时刻，
+// 匀速转动时球面插值和差分外推都是精确的，查询结果与解析解比较，同时统计查询耗时
+const std::string keys =
+  "{help h usage ? |      | 输出命令行参数说明          }"
+  "{readers r      | 4    | 读线程数                    }"
+  "{duration d     | 2    | 每个阶段的时长(s)           }"
+  "{rate           | 1000 | 限速阶段的写入频率(Hz)      }";
+
+using namespace std::chrono_literals;
+
+const Eigen::Vector3d AXIS = Eigen::Vector3d(1, 2, 3).normalized();
+constexpr double OMEGA = 10;     // 单位：rad/s
+constexpr double PERIOD = 1e-3;  // 样本的时间间隔，单位：s
+
+std::chrono::steady_clock::time_point T0 = std::chrono::steady_clock::now();
+
+std::chrono::steady_clock::time_point at_time(double t)
+{
+  return T0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(t));
+}
+
+Eigen::Quaterniond truth(double t)
+{
+  return Eigen::Quaterniond(Eigen::AngleAxisd(OMEGA * t, AXIS));
+}
+
+double angle_error(const Eigen::Quaterniond & a, const Eigen::Quaterniond & b)
+{
+  return 2 * std::acos(std::min(1.0, std::abs((a.conjugate() * b).w())));
+}
+
+// 单线程检查边界情况
+bool check_basics()
+{
+  auto ok = true;
+  auto expect = [&ok](bool condition, const std::string & what) {
+    if (!condition) {
+      tools::logger()->error("Basic check failed: {}", what);
+      ok = false;
+    }
+  };
+
+  tools::AttitudeHistory history(16, 0.01);
+  expect(history.at(at_time(0)).isApprox(Eigen::Quaterniond::Identity()), "empty returns identity");
+
+  for (int i = 0; i < 40; i++) history.push(at_time(i * PERIOD), truth(i * PERIOD));
+  expect(history.size() == 16, "size is bounded by capacity");
+
+  // 时间戳不增的样本被丢弃
+  history.push(at_time(39 * PERIOD), Eigen::Quaterniond::Identity());
+  expect(angle_error(history.at(at_time(39 * PERIOD)), truth(39 * PERIOD)) < 1e-6, "drop stale");
+
+  // 插值，反复查询同一时刻与更早的时刻
+  for (auto t : {0.0305, 0.0305, 0.0251, 0.0389})
+    expect(angle_error(history.at(at_time(t)), truth(t)) < 1e-6, fmt::format("interpolate {}", t));
+
+  // 早于最旧样本时返回最旧样本
+  expect(angle_error(history.at(at_time(0.001)), truth(0.024)) < 1e-6, "clamp to oldest");
+
+  // 差分外推，超过上限时只外推max_extrapolation
+  expect(angle_error(history.at(at_time(0.044)), truth(0.044)) < 1e-6, "extrapolate");
+  expect(angle_error(history.at(at_time(0.1)), truth(0.049)) < 1e-6, "bounded extrapolation");
+
+  // 陀螺仪外推
+  tools::AttitudeHistory gyro_history(16, 0.01);
+  gyro_history.push(at_time(0), truth(0), AXIS * OMEGA);
+  expect(angle_error(gyro_history.at(at_time(0.005)), truth(0.005)) < 1e-6, "gyro extrapolate");
+
+  history.clear();
+  expect(history.size() == 0, "clear");
+  expect(history.at(at_time(0.03)).isApprox(Eigen::Quaterniond::Identity()), "cleared identity");
+
+  return ok;
+}
+
+// 查询耗时按10ns分组统计，避免千万次查询逐个保存
+constexpr double BIN_NS = 10;
+constexpr std::size_t BINS = 10000;
+
+struct Result
+{
+  std::vector<std::size_t> histogram = std::vector<std::size_t>(BINS + 1, 0);
+  double max_ns = 0;
+  std::size_t queries = 0;
+  std::size_t errors = 0;
+
+  void add(double ns)
+  {
+    histogram[std::min(static_cast<std::size_t>(ns / BIN_NS), BINS)]++;
+    max_ns = std::max(max_ns, ns);
+    queries++;
+  }
+
+  double percentile(double p) const
+  {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i <= BINS; i++) {
+      count += histogram[i];
+      if (count > p * queries) return (i + 1) * BIN_NS;
+    }
+    return max_ns;
+  }
+};
+
+// 结果须等于t处的真值；读线程落后一整圈时，等于查询期间仍在缓冲区中的最旧样本也是正确的
+bool is_valid(const Eigen::Quaterniond & q, double t, int64_t newest)
+{
+  if (angle_error(q, truth(t)) < 1e-6) return true;
+  for (auto n = static_cast<int64_t>(std::ceil(t / PERIOD)); n <= newest; n++)
+    if (angle_error(q, truth(n * PERIOD)) < 1e-6) return true;
+  return false;
+}
+
+// 写线程rate为0时不限速，读线程常常落后一整圈，用于覆盖seqlock的重试路径
+bool run(int readers, double duration, double rate)
+{
+  tools::AttitudeHistory history;
+  std::atomic<int64_t> latest{-1};
+  std::atomic<bool> quit{false};
+
+  std::vector<Result> results(readers);
+  std::vector<std::thread> threads;
+  for (int r = 0; r < readers; r++) {
+    threads.emplace_back([&, r] {
+      std::mt19937 rng(r);
+      std::uniform_real_distribution<double> past(0, 0.02);
+      std::uniform_real_distribution<double> future(0, 0.005);
+      std::bernoulli_distribution ahead(0.2);
+      auto & result = results[r];
+
+      while (!quit) {
+        auto n = latest.load();
+        if (n < 2) continue;
+
+        auto t = n * PERIOD + (ahead(rng) ? future(rng) : -past(rng));
+        auto start = std::chrono::steady_clock::now();
+        auto q = history.at(at_time(t));
+        auto end = std::chrono::steady_clock::now();
+
+        result.add(std::chrono::duration<double, std::nano>(end - start).count());
+        if (!is_valid(q, t, latest.load())) result.errors++;
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(duration));
+  for (int64_t i = 0; std::chrono::steady_clock::now() < end; i++) {
+    history.push(at_time(i * PERIOD), truth(i * PERIOD));
+    latest = i;
+    if (rate > 0) std::this_thread::sleep_until(start + std::chrono::duration<double>(i / rate));
+  }
+  quit = true;
+  for (auto & thread : threads) thread.join();
+
+  Result total;
+  for (const auto & result : results) {
+    for (std::size_t i = 0; i <= BINS; i++) total.histogram[i] += result.histogram[i];
+    total.max_ns = std::max(total.max_ns, result.max_ns);
+    total.queries += result.queries;
+    total.errors += result.errors;
+  }
+  if (total.queries == 0) {
+    tools::logger()->error("No queries!");
+    return false;
+  }
+
+  tools::logger()->info(
+    "{} writer, {} readers: {} queries, {} errors, latency p50 {:.0f}ns p99 {:.0f}ns max {:.0f}ns",
+    rate > 0 ? fmt::format("{:.0f}Hz", rate) : "unthrottled", readers, total.queries, total.errors,
+    total.percentile(0.5), total.percentile(0.99), total.max_ns);
+
+  if (total.errors > 0) {
+    tools::logger()->error("Wrong attitudes returned!");
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto readers = cli.get<int>("readers");
+  auto duration = cli.get<double>("duration");
+  auto rate = cli.get<double>("rate");
+
+  auto ok = check_basics();
+  ok = run(readers, duration, rate) && ok;
+  ok = run(readers, duration, 0) && ok;
+
+  if (ok) tools::logger()->info("AttitudeHistory test passed.");
+  return ok ? 0 : 1;
+}
@@ -6,9 +6,9 @@
 #include <opencv2/opencv.hpp>
 
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/cascade_detector.hpp"
 #include "tasks/auto_aim/solver.hpp"
 #include "tasks/auto_aim/tracker.hpp"
-#include "tasks/auto_aim/yolo.hpp"
 #include "tools/exiter.hpp"
 #include "tools/img_tools.hpp"
 #include "tools/logger.hpp"
@@ -43,8 +43,8 @@ int main(int argc, char * argv[])
   cv::VideoCapture video(video_path);
   std::ifstream text(text_path);
 
-  auto_aim::YOLO yolo(config_path);
   auto_aim::Solver solver(config_path);
+  auto_aim::CascadeDetector detector(config_path, solver);
   auto_aim::Tracker tracker(config_path, solver);
   auto_aim::Aimer aimer(config_path);
 
@@ -52,6 +52,7 @@ int main(int argc, char * argv[])
   auto t0 = std::chrono::steady_clock::now();
 
   auto_aim::Target last_target;
+  std::list<auto_aim::Target> targets;
   io::Command last_command;
   double last_t = -1;
 
@@ -76,10 +77,10 @@ int main(int argc, char * argv[])
     solver.set_R_gimbal2world({w, x, y, z});
 
     auto yolo_start = std::chrono::steady_clock::now();
-    auto armors = yolo.detect(img, frame_count);
+    auto armors = detector.detect(img, timestamp, targets, frame_count);
 
     auto tracker_start = std::chrono::steady_clock::now();
-    auto targets = tracker.track(armors, timestamp);
+    targets = tracker.track(armors, timestamp);
 
     auto aimer_start = std::chrono::steady_clock::now();
     auto command = aimer.aim(targets, timestamp, 27, false);
@@ -94,11 +95,16 @@ int main(int argc, char * argv[])
 
     auto finish = std::chrono::steady_clock::now();
     tools::logger()->info(
-      "[{}] yolo: {:.1f}ms, tracker: {:.1f}ms, aimer: {:.1f}ms", frame_count,
-      tools::delta_time(tracker_start, yolo_start) * 1e3,
+      "[{}] yolo({}): {:.1f}ms (infer: {:.1f}ms, decode: {:.1f}ms), full: {:.1f}ms, "
+      "crop: {:.1f}ms, tracker: {:.1f}ms, aimer: {:.1f}ms",
+      frame_count, detector.last_is_crop() ? "crop" : "full",
+      tools::delta_time(tracker_start, yolo_start) * 1e3, detector.infer_ms(),
+      detector.decode_ms(), detector.full_ms(), detector.crop_ms(),
       tools::delta_time(aimer_start, tracker_start) * 1e3,
       tools::delta_time(finish, aimer_start) * 1e3);
 
+    if (detector.last_is_crop()) cv::rectangle(img, detector.last_crop(), {0, 255, 255}, 2);
+
     tools::draw_text(
       img,
       fmt::format(
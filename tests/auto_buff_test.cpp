@@ -44,7 +44,7 @@ int main(int argc, char * argv[])
   cv::VideoCapture video(video_path);
   std::ifstream text(text_path);
 
-  auto_buff::Buff_Detector detector(config_path);
+  auto_buff::Buff_Detector detector(config_path, true);
   auto_buff::Solver solver(config_path);
   // auto_buff::SmallTarget target;
   auto_buff::BigTarget target;
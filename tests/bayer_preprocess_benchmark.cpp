@@ -0,0 +1,137 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+#include "tools/pixel_format.hpp"
+
+// 对比相机原始Bayer数据从采集到网络输入张量的耗时：
+//   before: 采集线程整帧去马赛克为BGR，预处理再缩放到网络输入
+//   after:  采集线程只拷贝原始数据，预处理时去马赛克与缩放合并为一步
+const std::string keys =
+  "{help h usage ? |                      | 输出命令行参数说明                }"
+  "{format f       | bayer_rg             | 原始数据的Bayer格式               }"
+  "{raw r          |                      | 视频已是原始Bayer数据(灰度录制)   }"
+  "{input-size i   | 640                  | 网络输入边长                      }"
+  "{@video_path    | assets/demo/demo.avi | avi路径，彩色视频按format重新马赛克}";
+
+// 按Bayer格式从BGR图像中取样，模拟相机的原始输出
+cv::Mat mosaic(const cv::Mat & bgr, tools::PixelFormat format)
+{
+  // R像素在2x2单元中的位置
+  auto rx = (format == tools::PixelFormat::bayer_gr || format == tools::PixelFormat::bayer_bg);
+  auto ry = (format == tools::PixelFormat::bayer_gb || format == tools::PixelFormat::bayer_bg);
+
+  cv::Mat raw(bgr.size(), CV_8UC1);
+  for (int y = 0; y < bgr.rows; y++) {
+    const auto * src = bgr.ptr<cv::Vec3b>(y);
+    auto * dst = raw.ptr<uchar>(y);
+    for (int x = 0; x < bgr.cols; x++) {
+      auto is_red_row = (y & 1) == ry, is_red_col = (x & 1) == rx;
+      if (is_red_row && is_red_col)
+        dst[x] = src[x][2];
+      else if (!is_red_row && !is_red_col)
+        dst[x] = src[x][0];
+      else
+        dst[x] = src[x][1];
+    }
+  }
+  return raw;
+}
+
+double get_scale(const cv::Size & img_size, int input_size)
+{
+  auto x_scale = static_cast<double>(input_size) / img_size.height;
+  auto y_scale = static_cast<double>(input_size) / img_size.width;
+  return std::min(x_scale, y_scale);
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto video_path = cli.get<std::string>(0);
+  auto format = tools::pixel_format(cli.get<std::string>("format"));
+  auto is_raw = cli.has("raw");
+  auto input_size = cli.get<int>("input-size");
+
+  if (!tools::is_bayer(format)) {
+    tools::logger()->error("format must be one of bayer_rg, bayer_gr, bayer_gb, bayer_bg");
+    return 1;
+  }
+
+  cv::VideoCapture video(video_path);
+  if (!video.isOpened()) {
+    tools::logger()->error("Failed to open {}", video_path);
+    return 1;
+  }
+
+  // 与InferPool相同，输入张量和采集缓冲区都预先分配
+  cv::Mat before_input(input_size, input_size, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::Mat after_input(input_size, input_size, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::Mat sdk_buffer;
+  cv::Mat captured_bgr, captured_raw;  // 采集到的帧来自FramePool，逐帧复用
+
+  double before_capture = 0, before_preprocess = 0, after_capture = 0, after_preprocess = 0;
+  double diff_sum = 0;
+  int frames = 0;
+
+  for (cv::Mat img; video.read(img) && !img.empty(); frames++) {
+    // 灰度录制的视频解码后为三个相同的通道
+    if (is_raw)
+      cv::extractChannel(img, sdk_buffer, 0);
+    else
+      sdk_buffer = mosaic(img, format);
+
+    auto scale = get_scale(sdk_buffer.size(), input_size);
+    auto w = static_cast<int>(sdk_buffer.cols * scale);
+    auto h = static_cast<int>(sdk_buffer.rows * scale);
+
+    // before
+    auto t0 = std::chrono::steady_clock::now();
+    tools::to_bgr(sdk_buffer, format, captured_bgr);
+    auto t1 = std::chrono::steady_clock::now();
+    auto before_roi = before_input(cv::Rect(0, 0, w, h));
+    cv::resize(captured_bgr, before_roi, {w, h});
+    auto t2 = std::chrono::steady_clock::now();
+
+    // after
+    captured_raw.create(sdk_buffer.size(), CV_8UC1);
+    sdk_buffer.copyTo(captured_raw);
+    auto t3 = std::chrono::steady_clock::now();
+    auto after_roi = after_input(cv::Rect(0, 0, w, h));
+    tools::bayer_resize(captured_raw, format, after_roi);
+    auto t4 = std::chrono::steady_clock::now();
+
+    before_capture += tools::delta_time(t1, t0);
+    before_preprocess += tools::delta_time(t2, t1);
+    after_capture += tools::delta_time(t3, t2);
+    after_preprocess += tools::delta_time(t4, t3);
+
+    cv::Mat diff;
+    cv::absdiff(before_roi, after_roi, diff);
+    diff_sum += cv::mean(diff.reshape(1))[0];
+  }
+
+  if (frames == 0) {
+    tools::logger()->warn("No frames read!");
+    return 0;
+  }
+
+  auto ms = [frames](double sum) { return sum / frames * 1e3; };
+  tools::logger()->info("{} frames, input {}x{}", frames, input_size, input_size);
+  tools::logger()->info(
+    "before: capture {:.3f}ms + preprocess {:.3f}ms = {:.3f}ms", ms(before_capture),
+    ms(before_preprocess), ms(before_capture + before_preprocess));
+  tools::logger()->info(
+    " after: capture {:.3f}ms + preprocess {:.3f}ms = {:.3f}ms", ms(after_capture),
+    ms(after_preprocess), ms(after_capture + after_preprocess));
+  tools::logger()->info("mean abs diff of network input: {:.2f}", diff_sum / frames);
+
+  return 0;
+}
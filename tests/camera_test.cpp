@@ -1,6 +1,10 @@
 #include "io/camera.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
 
 #include "tools/exiter.hpp"
 #include "tools/logger.hpp"
@@ -9,7 +13,35 @@
 const std::string keys =
   "{help h usage ? |                     | 输出命令行参数说明}"
   "{config-path c  | configs/camera.yaml | yaml配置文件路径 }"
-  "{d display      |                     | 显示视频流       }";
+  "{d display      |                     | 显示视频流       }"
+  "{bin            | 0.25                | 抖动直方图的组距(ms)}";
+
+// 帧从曝光中点到read返回的延迟直方图，采集轮询带来的抖动表现为分布变宽
+void print_histogram(const std::vector<double> & latencies, double bin_ms)
+{
+  if (latencies.empty()) return;
+
+  auto [min, max] = std::minmax_element(latencies.begin(), latencies.end());
+  auto first = static_cast<int>(std::floor(*min / bin_ms));
+  auto last = static_cast<int>(std::floor(*max / bin_ms));
+  std::vector<int> counts(last - first + 1, 0);
+  for (auto latency : latencies) counts[static_cast<int>(std::floor(latency / bin_ms)) - first]++;
+
+  auto sorted = latencies;
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+  tools::logger()->info(
+    "capture latency: p50 {:.3f}ms, p99 {:.3f}ms, p99-p50 jitter {:.3f}ms, {} frames",
+    percentile(0.5), percentile(0.99), percentile(0.99) - percentile(0.5), latencies.size());
+
+  auto peak = *std::max_element(counts.begin(), counts.end());
+  for (size_t i = 0; i < counts.size(); i++) {
+    if (counts[i] == 0) continue;
+    auto lower = (first + static_cast<int>(i)) * bin_ms;
+    auto bar = std::string(counts[i] * 50 / peak, '#');
+    tools::logger()->info("{:7.2f}ms {:6d} {}", lower, counts[i], bar);
+  }
+}
 
 int main(int argc, char * argv[])
 {
@@ -23,21 +55,35 @@ int main(int argc, char * argv[])
 
   auto config_path = cli.get<std::string>("config-path");
   auto display = cli.has("display");
+  auto bin_ms = cli.get<double>("bin");
   io::Camera camera(config_path);
 
   cv::Mat img;
   std::chrono::steady_clock::time_point timestamp;
   auto last_stamp = std::chrono::steady_clock::now();
+  std::vector<double> latencies;
   while (!exiter.exit()) {
     camera.read(img, timestamp);
+    auto arrival = std::chrono::steady_clock::now();
+    latencies.push_back(tools::delta_time(arrival, timestamp) * 1e3);
 
     auto dt = tools::delta_time(timestamp, last_stamp);
     last_stamp = timestamp;
 
-    tools::logger()->info("{:.2f} fps", 1 / dt);
+    auto pool = camera.frame_pool_stats();
+    tools::logger()->info(
+      "{:.2f} fps, frame pool: {} in use, reused {}/{}, exhausted {}", 1 / dt, pool.in_use,
+      pool.reused, pool.acquired, pool.exhausted);
+
+    auto clock = camera.clock_metrics();
+    tools::logger()->info(
+      "device clock: offset {:.6f}s, drift {:.1f}ppm, residual {:.3f}ms, {} samples, {} resets",
+      clock.offset, clock.drift, clock.residual * 1e3, clock.samples, clock.resets);
 
     if (!display) continue;
     cv::imshow("img", img);
     if (cv::waitKey(1) == 'q') break;
   }
-}
\ No newline at end of file
+
+  print_histogram(latencies, bin_ms);
+}
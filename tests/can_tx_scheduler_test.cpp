@@ -0,0 +1,165 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "io/can_tx_scheduler.hpp"
+#include "io/socketcan.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+// 在vcan回环上检验CANTxScheduler：两个ID交错快速提交递增的计数，接收端检查
+//   顺序: 同一ID收到的计数严格递增，且最后一次提交的计数一定被发出
+//   限速: 同一ID相邻两帧的间隔不小于发送周期
+//   去重: 内容不变的帧只按keepalive重发
+// 准备vcan: sudo modprobe vcan && sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+const std::string keys =
+  "{help h usage ? |       | 输出命令行参数说明            }"
+  "{interface i    | vcan0 | CAN接口                       }"
+  "{count n        | 5000  | 每个ID提交的帧数              }"
+  "{rate r         | 500   | 每个ID的最高发送频率(Hz)      }"
+  "{keepalive k    | 0.05  | 内容不变时的重发间隔(s)       }";
+
+constexpr canid_t IDS[] = {0x100, 0x101};
+
+struct Received
+{
+  std::vector<int> values;
+  std::vector<std::chrono::steady_clock::time_point> timestamps;
+};
+
+can_frame make_frame(canid_t id, int value)
+{
+  can_frame frame{};
+  frame.can_id = id;
+  frame.can_dlc = 8;
+  std::memcpy(frame.data, &value, sizeof(value));
+  return frame;
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto interface = cli.get<std::string>("interface");
+  auto count = cli.get<int>("count");
+  auto rate = cli.get<double>("rate");
+  auto keepalive = cli.get<double>("keepalive");
+
+  std::mutex mutex;
+  Received received[2];
+  io::SocketCAN receiver(interface, [&](const can_frame & frame, auto timestamp) {
+    for (int i = 0; i < 2; i++) {
+      if (frame.can_id != IDS[i]) continue;
+      int value;
+      std::memcpy(&value, frame.data, sizeof(value));
+      std::lock_guard<std::mutex> lock(mutex);
+      received[i].values.push_back(value);
+      received[i].timestamps.push_back(timestamp);
+    }
+  });
+  io::SocketCAN sender(interface, [](const can_frame &, auto) {});
+
+  // 等待两个socket都打开
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  auto ok = true;
+  {
+    io::CANTxScheduler tx(sender, rate, keepalive);
+
+    // 阶段一: 以远高于rate的频率提交，检验合并与限速
+    auto t0 = std::chrono::steady_clock::now();
+    double submit_max = 0;
+    for (int v = 1; v <= count; v++) {
+      for (auto id : IDS) {
+        auto t = std::chrono::steady_clock::now();
+        tx.submit(make_frame(id, v));
+        submit_max = std::max(submit_max, tools::delta_time(std::chrono::steady_clock::now(), t));
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    auto submit_time = tools::delta_time(std::chrono::steady_clock::now(), t0);
+
+    // 阶段二: 内容不变，持续提交1s，应只有约1/keepalive帧
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::size_t before;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      before = received[0].values.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    while (tools::delta_time(std::chrono::steady_clock::now(), t1) < 1.0) {
+      tx.submit(make_frame(IDS[0], count));
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto stats = tx.stats();
+    tools::logger()->info(
+      "submitted {}, sent {}, coalesced {}, suppressed {}, busy {}, errors {}", stats.submitted,
+      stats.sent, stats.coalesced, stats.suppressed, stats.busy, stats.errors);
+    tools::logger()->info(
+      "latency: mean {:.3f}ms, max {:.3f}ms; submit: max {:.3f}ms over {:.2f}s",
+      stats.latency_mean * 1e3, stats.latency_max * 1e3, submit_max * 1e3, submit_time);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received[0].values.empty() && received[1].values.empty()) {
+      tools::logger()->error("No frames received. Is {} up?", interface);
+      return 1;
+    }
+
+    auto resent = received[0].values.size() - before;
+    auto expected = 1.0 / keepalive;
+    tools::logger()->info("keepalive: {} frames in 1s, expected about {:.0f}", resent, expected);
+    if (resent > expected * 1.2 + 2 || resent < expected * 0.5) {
+      tools::logger()->error("Unchanged frames not resent at keepalive interval!");
+      ok = false;
+    }
+
+    // 阶段一的帧
+    auto period = 1.0 / rate;
+    for (int i = 0; i < 2; i++) {
+      auto & r = received[i];
+      auto n = (i == 0) ? before : r.values.size();
+      double min_interval = 1e9;
+      auto ordered = true;
+      for (std::size_t j = 1; j < n; j++) {
+        ordered = ordered && r.values[j] > r.values[j - 1];
+        auto interval = tools::delta_time(r.timestamps[j], r.timestamps[j - 1]);
+        min_interval = std::min(min_interval, interval);
+      }
+
+      tools::logger()->info(
+        "id {:#x}: {} frames, last {}, min interval {:.3f}ms (period {:.3f}ms)", IDS[i], n,
+        n ? r.values[n - 1] : 0, min_interval * 1e3, period * 1e3);
+
+      if (!ordered) {
+        tools::logger()->error("id {:#x}: frames out of order!", IDS[i]);
+        ok = false;
+      }
+      if (n == 0 || r.values[n - 1] != count) {
+        tools::logger()->error("id {:#x}: latest command was not sent!", IDS[i]);
+        ok = false;
+      }
+      // 内核时间戳有调度抖动，留10%余量
+      if (min_interval < 0.9 * period) {
+        tools::logger()->error("id {:#x}: rate limit exceeded!", IDS[i]);
+        ok = false;
+      }
+      if (n > submit_time * rate * 1.1 + 10) {
+        tools::logger()->error("id {:#x}: too many frames sent!", IDS[i]);
+        ok = false;
+      }
+    }
+  }
+
+  if (ok) tools::logger()->info("CANTxScheduler test passed.");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <random>
+
+#include "tools/clock_model.hpp"
+#include "tools/logger.hpp"
+
+// 用合成的时间戳检验ClockModel：设备时钟带漂移和偏移，主机收到帧的时刻带传输延迟、
+// 取图循环的抖动和偶发的积压，中途设备重连使设备时钟从0重新开始
+const std::string keys =
+  "{help h usage ? |       | 输出命令行参数说明          }"
+  "{frames n       | 20000 | 帧数                        }"
+  "{fps            | 150   | 帧率                        }"
+  "{drift          | 80    | 设备时钟漂移(ppm)           }"
+  "{latency        | 0.004 | 最小传输延迟(s)             }"
+  "{seed           | 0     | 随机种子                    }";
+
+struct Error
+{
+  double sum = 0, max = 0;
+  int count = 0;
+
+  void add(double e)
+  {
+    sum += std::abs(e);
+    max = std::max(max, std::abs(e));
+    count++;
+  }
+
+  double mean() const { return count ? sum / count : 0.0; }
+};
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto frames = cli.get<int>("frames");
+  auto fps = cli.get<double>("fps");
+  auto drift = cli.get<double>("drift") * 1e-6;
+  auto latency = cli.get<double>("latency");
+  auto seed = cli.get<int>("seed");
+
+  std::mt19937 rng(seed);
+  std::exponential_distribution<double> transfer_jitter(1 / 0.0003);
+  std::uniform_real_distribution<double> loop_jitter(0, 0.001);
+
+  tools::ClockModel model;
+  auto t0 = std::chrono::steady_clock::now();
+
+  // 主机时刻t曝光的帧，设备时间戳为(t - boot) * (1 + drift)
+  auto boot = -1234.5;
+  auto reconnect = frames / 2;
+
+  Error raw, mapped;
+  auto warmup = 0;
+  for (int i = 0; i < frames; i++) {
+    auto exposure = i / fps;
+    if (i == reconnect) {
+      boot = exposure - 0.5;
+      warmup = i + 100;
+    }
+
+    auto device_time = (exposure - boot) * (1 + drift);
+
+    // 每500帧有一帧在SDK中积压0.15s
+    auto delay = latency + transfer_jitter(rng) + loop_jitter(rng);
+    if (i % 500 == 499) delay += 0.15;
+
+    auto host = t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(exposure + delay));
+    auto stamp = model.update(device_time, host);
+
+    // 模型对齐的是最小传输延迟处的下包络
+    if (i < 100 || i < warmup) continue;
+    auto expected = exposure + latency;
+    raw.add(std::chrono::duration<double>(host - t0).count() - expected);
+    mapped.add(std::chrono::duration<double>(stamp - t0).count() - expected);
+  }
+
+  auto metrics = model.metrics();
+  tools::logger()->info(
+    "arrival error: mean {:.3f}ms, max {:.3f}ms", raw.mean() * 1e3, raw.max * 1e3);
+  tools::logger()->info(
+    " mapped error: mean {:.3f}ms, max {:.3f}ms", mapped.mean() * 1e3, mapped.max * 1e3);
+  tools::logger()->info(
+    "offset {:.6f}s, drift {:.1f}ppm (true {:.1f}ppm), residual {:.3f}ms, {} samples, {} resets",
+    metrics.offset, metrics.drift, drift * 1e6, metrics.residual * 1e3, metrics.samples,
+    metrics.resets);
+
+  auto ok = true;
+  if (mapped.mean() > 0.2 * raw.mean()) {
+    tools::logger()->error("Mapped timestamps are not better than arrival timestamps!");
+    ok = false;
+  }
+  if (mapped.max > 0.5e-3) {
+    tools::logger()->error("Mapped timestamp error exceeds 0.5ms!");
+    ok = false;
+  }
+  if (std::abs(metrics.drift - drift * 1e6) > 20) {
+    tools::logger()->error("Drift estimate off by more than 20ppm!");
+    ok = false;
+  }
+  if (metrics.resets != 1) {
+    tools::logger()->error("Expected exactly one reset, got {}!", metrics.resets);
+    ok = false;
+  }
+
+  if (ok) tools::logger()->info("ClockModel test passed.");
+  return ok ? 0 : 1;
+}
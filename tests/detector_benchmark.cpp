@@ -0,0 +1,278 @@
+#include <fmt/core.h>
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <numeric>
+#include <opencv2/opencv.hpp>
+
+#include "tasks/auto_aim/binarize.hpp"
+#include "tasks/auto_aim/lightbar_extractor.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                       | 输出命令行参数说明 }"
+  "{config-path c  | configs/demo.yaml     | yaml配置文件的路径}"
+  "{repeat r       | 1                     | 每帧重复次数      }"
+  "{@video_path    | assets/demo/demo.avi  | avi路径}";
+
+// 原有流程：cvtColor + threshold + 逐轮廓点取色
+int legacy(const cv::Mat & bgr_img, double threshold)
+{
+  cv::Mat gray_img, binary_img;
+  cv::cvtColor(bgr_img, gray_img, cv::COLOR_BGR2GRAY);
+  cv::threshold(gray_img, binary_img, threshold, 255, cv::THRESH_BINARY);
+
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+
+  int blue_count = 0;
+  for (const auto & contour : contours) {
+    int red_sum = 0, blue_sum = 0;
+    for (const auto & point : contour) {
+      red_sum += bgr_img.at<cv::Vec3b>(point)[2];
+      blue_sum += bgr_img.at<cv::Vec3b>(point)[0];
+    }
+    if (blue_sum > red_sum) blue_count++;
+  }
+  return blue_count;
+}
+
+// 融合流程：binarize单次遍历 + 从差值图取色
+int fused(const cv::Mat & bgr_img, double threshold)
+{
+  cv::Mat binary_img, color_img;
+  auto_aim::binarize(bgr_img, threshold, binary_img, color_img);
+
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+
+  int blue_count = 0;
+  for (const auto & contour : contours) {
+    int diff_sum = 0;
+    for (const auto & point : contour) diff_sum += color_img.at<schar>(point);
+    if (diff_sum < 0) blue_count++;
+  }
+  return blue_count;
+}
+
+// 原有角点修正：逐像素构造点云做PCA，逐点采样
+void legacy_refine(auto_aim::Lightbar & lightbar, const cv::Mat & gray_img)
+{
+  // 配置参数
+  constexpr float MAX_BRIGHTNESS = 25;  // 归一化最大亮度值
+  constexpr float ROI_SCALE = 0.07;     // ROI扩展比例
+  constexpr float SEARCH_START = 0.4;   // 搜索起始位置比例（原0.8/2）
+  constexpr float SEARCH_END = 0.6;     // 搜索结束位置比例（原1.2/2）
+
+  // 扩展并裁剪ROI
+  cv::Rect roi_box = lightbar.rotated_rect.boundingRect();
+  roi_box.x -= roi_box.width * ROI_SCALE;
+  roi_box.y -= roi_box.height * ROI_SCALE;
+  roi_box.width += 2 * roi_box.width * ROI_SCALE;
+  roi_box.height += 2 * roi_box.height * ROI_SCALE;
+
+  // 边界约束
+  roi_box &= cv::Rect(0, 0, gray_img.cols, gray_img.rows);
+
+  // 归一化ROI
+  cv::Mat roi = gray_img(roi_box);
+  const float mean_val = cv::mean(roi)[0];
+  roi.convertTo(roi, CV_32F);
+  cv::normalize(roi, roi, 0, MAX_BRIGHTNESS, cv::NORM_MINMAX);
+
+  // 计算质心
+  const cv::Moments moments = cv::moments(roi);
+  const cv::Point2f centroid(
+    moments.m10 / moments.m00 + roi_box.x, moments.m01 / moments.m00 + roi_box.y);
+
+  // 生成稀疏点云（优化性能）
+  std::vector<cv::Point2f> points;
+  for (int i = 0; i < roi.rows; ++i) {
+    for (int j = 0; j < roi.cols; ++j) {
+      const float weight = roi.at<float>(i, j);
+      if (weight > 1e-3) {          // 忽略极小值提升性能
+        points.emplace_back(j, i);  // 坐标相对于ROI区域
+      }
+    }
+  }
+
+  // PCA计算对称轴方向
+  cv::PCA pca(cv::Mat(points).reshape(1), cv::Mat(), cv::PCA::DATA_AS_ROW);
+  cv::Point2f axis(pca.eigenvectors.at<float>(0, 0), pca.eigenvectors.at<float>(0, 1));
+  axis /= cv::norm(axis);
+  if (axis.y > 0) axis = -axis;  // 统一方向
+
+  const auto find_corner = [&](int direction) -> cv::Point2f {
+    const float dx = axis.x * direction;
+    const float dy = axis.y * direction;
+    const float search_length = lightbar.length * (SEARCH_END - SEARCH_START);
+
+    std::vector<cv::Point2f> candidates;
+
+    // 横向采样多个候选线
+    const int half_width = (lightbar.width - 2) / 2;
+    for (int i_offset = -half_width; i_offset <= half_width; ++i_offset) {
+      // 计算搜索起点
+      cv::Point2f start_point(
+        centroid.x + lightbar.length * SEARCH_START * dx + i_offset,
+        centroid.y + lightbar.length * SEARCH_START * dy);
+
+      // 沿轴搜索亮度跳变点
+      cv::Point2f corner = start_point;
+      float max_diff = 0;
+      bool found = false;
+
+      for (float step = 0; step < search_length; ++step) {
+        const cv::Point2f cur_point(start_point.x + dx * step, start_point.y + dy * step);
+
+        // 边界检查
+        if (
+          cur_point.x < 0 || cur_point.x >= gray_img.cols || cur_point.y < 0 ||
+          cur_point.y >= gray_img.rows) {
+          break;
+        }
+
+        // 计算亮度差（使用双线性插值提升精度）
+        const auto prev_val = gray_img.at<uchar>(cv::Point2i(cur_point - cv::Point2f(dx, dy)));
+        const auto cur_val = gray_img.at<uchar>(cv::Point2i(cur_point));
+        const float diff = prev_val - cur_val;
+
+        if (diff > max_diff && prev_val > mean_val) {
+          max_diff = diff;
+          corner = cur_point - cv::Point2f(dx, dy);  // 跳变发生在上一位置
+          found = true;
+        }
+      }
+
+      if (found) {
+        candidates.push_back(corner);
+      }
+    }
+
+    // 返回候选点均值
+    return candidates.empty()
+             ? cv::Point2f(-1, -1)
+             : std::accumulate(candidates.begin(), candidates.end(), cv::Point2f(0, 0)) /
+                 static_cast<float>(candidates.size());
+  };
+
+  // 并行检测顶部和底部
+  lightbar.top = find_corner(1);
+  lightbar.bottom = find_corner(-1);
+}
+
+int main(int argc, char * argv[])
+{
+  // 读取命令行参数
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto video_path = cli.get<std::string>(0);
+  auto config_path = cli.get<std::string>("config-path");
+  auto repeat = std::max(1, cli.get<int>("repeat"));
+
+  auto yaml = YAML::LoadFile(config_path);
+  auto threshold = yaml["threshold"].as<double>();
+
+  auto_aim::LightbarExtractor extractor(config_path);
+
+  cv::VideoCapture video(video_path);
+  if (!video.isOpened()) {
+    tools::logger()->error("Failed to open {}", video_path);
+    return 1;
+  }
+
+  double legacy_sum = 0, fused_sum = 0, contours_sum = 0, components_sum = 0;
+  double legacy_refine_sum = 0, refine_sum = 0;
+  int frames = 0, mismatch = 0;
+  std::size_t lightbar_sum = 0;
+
+  for (cv::Mat img; video.read(img) && !img.empty(); frames++) {
+    // 校验二值图一致
+    cv::Mat gray_img, expected, binary_img, color_img;
+    cv::cvtColor(img, gray_img, cv::COLOR_BGR2GRAY);
+    cv::threshold(gray_img, expected, threshold, 255, cv::THRESH_BINARY);
+    auto_aim::binarize(img, threshold, binary_img, color_img);
+    mismatch += cv::countNonZero(expected != binary_img);
+
+    int legacy_blue = 0, fused_blue = 0;
+
+    auto legacy_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) legacy_blue = legacy(img, threshold);
+
+    auto fused_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) fused_blue = fused(img, threshold);
+
+    auto finish = std::chrono::steady_clock::now();
+    auto legacy_ms = tools::delta_time(fused_start, legacy_start) * 1e3 / repeat;
+    auto fused_ms = tools::delta_time(finish, fused_start) * 1e3 / repeat;
+    legacy_sum += legacy_ms;
+    fused_sum += fused_ms;
+
+    // 灯条提取：轮廓法与连通域法
+    std::size_t contours_num = 0, components_num = 0;
+
+    auto contours_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++)
+      contours_num = extractor.extract_by_contours(binary_img, color_img).size();
+
+    auto components_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++)
+      components_num = extractor.extract_by_components(binary_img, color_img).size();
+
+    auto extract_finish = std::chrono::steady_clock::now();
+    auto contours_ms = tools::delta_time(components_start, contours_start) * 1e3 / repeat;
+    auto components_ms = tools::delta_time(extract_finish, components_start) * 1e3 / repeat;
+    contours_sum += contours_ms;
+    components_sum += components_ms;
+
+    // 角点修正：逐灯条计时，每次都在未修正的副本上进行
+    auto lightbars = extractor.extract_by_contours(binary_img, color_img);
+    auto refined = lightbars;
+
+    auto legacy_refine_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+      refined = lightbars;
+      for (auto & lightbar : refined) legacy_refine(lightbar, gray_img);
+    }
+
+    auto refine_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+      refined = lightbars;
+      for (auto & lightbar : refined) extractor.refine_points(lightbar, gray_img);
+    }
+
+    auto refine_finish = std::chrono::steady_clock::now();
+    legacy_refine_sum += tools::delta_time(refine_start, legacy_refine_start) * 1e6 / repeat;
+    refine_sum += tools::delta_time(refine_finish, refine_start) * 1e6 / repeat;
+    lightbar_sum += lightbars.size();
+
+    tools::logger()->info(
+      "[{}] legacy: {:.2f}ms, fused: {:.2f}ms, blue: {}/{}, contours: {:.2f}ms ({}), "
+      "components: {:.2f}ms ({})",
+      frames, legacy_ms, fused_ms, legacy_blue, fused_blue, contours_ms, contours_num,
+      components_ms, components_num);
+  }
+
+  if (frames == 0) return 1;
+
+  tools::logger()->info(
+    "{} frames {}x{}, legacy: {:.2f}ms/frame, fused: {:.2f}ms/frame, binary mismatch: {}px",
+    frames, static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH)),
+    static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT)), legacy_sum / frames,
+    fused_sum / frames, mismatch);
+  tools::logger()->info(
+    "lightbar extractor, contours: {:.2f}ms/frame, components: {:.2f}ms/frame",
+    contours_sum / frames, components_sum / frames);
+
+  if (lightbar_sum == 0) return 0;
+
+  tools::logger()->info(
+    "lightbar refine, {} lightbars, pca: {:.2f}us/lightbar, moments: {:.2f}us/lightbar",
+    lightbar_sum, legacy_refine_sum / lightbar_sum, refine_sum / lightbar_sum);
+
+  return 0;
+}
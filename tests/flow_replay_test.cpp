@@ -0,0 +1,182 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+
+#include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/cascade_detector.hpp"
+#include "tasks/auto_aim/solver.hpp"
+#include "tasks/auto_aim/tracker.hpp"
+#include "tasks/auto_aim/yolo.hpp"
+#include "tools/exiter.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+// 离线回放，对比逐帧检测与光流传播(配置中flow_interval > 1)的跟踪质量和CPU占用
+const std::string keys =
+  "{help h usage ? |                   | 输出命令行参数说明 }"
+  "{config-path c  | configs/demo.yaml | yaml配置文件的路径}"
+  "{start-index s  | 0                 | 视频起始帧下标    }"
+  "{end-index e    | 0                 | 视频结束帧下标    }"
+  "{@input-path    | assets/demo/demo  | avi和txt文件的路径}";
+
+struct Stats
+{
+  int frames = 0;
+  int tracking = 0;
+  double wall_ms = 0;
+  double cpu_ms = 0;
+  double nis_sum = 0;
+  int nis_count = 0;
+
+  void count(const std::list<auto_aim::Target> & targets)
+  {
+    frames++;
+    if (targets.empty()) return;
+    tracking++;
+    nis_sum += targets.front().ekf().data.at("nis");
+    nis_count++;
+  }
+
+  void log(const std::string & name) const
+  {
+    tools::logger()->info(
+      "{:>9}: wall {:.2f}ms/frame, cpu {:.2f}ms/frame, tracking {}/{}, mean nis {:.3f}", name,
+      wall_ms / frames, cpu_ms / frames, tracking, frames, nis_count ? nis_sum / nis_count : 0.0);
+  }
+};
+
+// 进程CPU时间，包含推理后端的线程
+double cpu_ms() { return std::clock() * 1e3 / CLOCKS_PER_SEC; }
+
+// 光流结果与同一帧检测结果中同名且中心最近的装甲板比较，返回角点的平均误差，无匹配时返回-1
+double keypoint_error(const auto_aim::Armor & armor, const std::list<auto_aim::Armor> & detected)
+{
+  const auto_aim::Armor * nearest = nullptr;
+  for (const auto & d : detected) {
+    if (d.name != armor.name) continue;
+    if (!nearest || cv::norm(d.center - armor.center) < cv::norm(nearest->center - armor.center))
+      nearest = &d;
+  }
+  if (!nearest) return -1;
+
+  double sum = 0;
+  for (int i = 0; i < 4; i++) sum += cv::norm(nearest->points[i] - armor.points[i]);
+  return sum / 4;
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto input_path = cli.get<std::string>(0);
+  auto config_path = cli.get<std::string>("config-path");
+  auto start_index = cli.get<int>("start-index");
+  auto end_index = cli.get<int>("end-index");
+
+  tools::Exiter exiter;
+
+  cv::VideoCapture video(fmt::format("{}.avi", input_path));
+  std::ifstream text(fmt::format("{}.txt", input_path));
+
+  // 两条流水线共用同一个Solver，每帧设置一次姿态
+  auto_aim::Solver solver(config_path);
+
+  auto_aim::YOLO yolo(config_path, false);
+  auto_aim::Tracker ref_tracker(config_path, solver);
+  auto_aim::Aimer ref_aimer(config_path);
+
+  auto_aim::CascadeDetector detector(config_path, solver);
+  auto_aim::Tracker flow_tracker(config_path, solver);
+  auto_aim::Aimer flow_aimer(config_path);
+
+  cv::Mat img;
+  auto t0 = std::chrono::steady_clock::now();
+  std::list<auto_aim::Target> ref_targets, flow_targets;
+  Stats ref, flow;
+
+  int flow_frames = 0, matched = 0, both_control = 0;
+  double error_sum = 0, error_max = 0, yaw_sum = 0, pitch_sum = 0;
+
+  video.set(cv::CAP_PROP_POS_FRAMES, start_index);
+  for (int i = 0; i < start_index; i++) {
+    double t, w, x, y, z;
+    text >> t >> w >> x >> y >> z;
+  }
+
+  for (int frame_count = start_index; !exiter.exit(); frame_count++) {
+    if (end_index > 0 && frame_count > end_index) break;
+
+    video.read(img);
+    if (img.empty()) break;
+
+    double t, w, x, y, z;
+    text >> t >> w >> x >> y >> z;
+    auto timestamp = t0 + std::chrono::microseconds(int(t * 1e6));
+
+    solver.set_R_gimbal2world({w, x, y, z});
+
+    // 逐帧检测
+    auto ref_start = std::chrono::steady_clock::now();
+    auto ref_cpu_start = cpu_ms();
+    auto ref_armors = yolo.detect(img, frame_count);
+    auto detected = ref_armors;
+    ref_targets = ref_tracker.track(ref_armors, timestamp);
+    auto ref_command = ref_aimer.aim(ref_targets, timestamp, 27, false);
+    ref.cpu_ms += cpu_ms() - ref_cpu_start;
+    ref.wall_ms += tools::delta_time(std::chrono::steady_clock::now(), ref_start) * 1e3;
+
+    // 检测与光流交替
+    auto flow_start = std::chrono::steady_clock::now();
+    auto flow_cpu_start = cpu_ms();
+    auto flow_armors = detector.detect(img, timestamp, flow_targets, frame_count);
+    auto propagated = flow_armors;
+    flow_targets = flow_tracker.track(flow_armors, timestamp);
+    auto flow_command = flow_aimer.aim(flow_targets, timestamp, 27, false);
+    flow.cpu_ms += cpu_ms() - flow_cpu_start;
+    flow.wall_ms += tools::delta_time(std::chrono::steady_clock::now(), flow_start) * 1e3;
+
+    ref.count(ref_targets);
+    flow.count(flow_targets);
+
+    if (detector.last_is_flow()) {
+      flow_frames++;
+      for (const auto & armor : propagated) {
+        auto error = keypoint_error(armor, detected);
+        if (error < 0) continue;
+        matched++;
+        error_sum += error;
+        error_max = std::max(error_max, error);
+      }
+    }
+
+    if (ref_command.control && flow_command.control) {
+      both_control++;
+      yaw_sum += std::abs(tools::limit_rad(ref_command.yaw - flow_command.yaw));
+      pitch_sum += std::abs(ref_command.pitch - flow_command.pitch);
+    }
+  }
+
+  if (ref.frames == 0) {
+    tools::logger()->warn("No frames replayed!");
+    return 0;
+  }
+  if (flow_frames == 0) tools::logger()->warn("Optical flow never used, check flow_interval!");
+
+  ref.log("detection");
+  flow.log("flow");
+  tools::logger()->info(
+    "flow frames {}/{}, keypoint error vs detection: mean {:.2f}px, max {:.2f}px ({} armors)",
+    flow_frames, flow.frames, matched ? error_sum / matched : 0.0, error_max, matched);
+  tools::logger()->info(
+    "command diff: yaw {:.3f}deg, pitch {:.3f}deg ({} frames)",
+    both_control ? yaw_sum / both_control * 57.3 : 0.0,
+    both_control ? pitch_sum / both_control * 57.3 : 0.0, both_control);
+
+  return 0;
+}
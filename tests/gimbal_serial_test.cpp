@@ -0,0 +1,226 @@
+#include <fmt/core.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "io/gimbal/gimbal.hpp"
+#include "io/gimbal/packet_parser.hpp"
+#include "tools/crc.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+// 用伪终端模拟下位机检验Gimbal的串口收发：
+//   接收: 尽快发送GimbalToVision，yaw为递增的序号，每隔若干包插入随机字节、截断的包或CRC错误的包，
+//         检查所有完整的包都被解析出来，统计每秒包数
+//   发送: 控制线程快速调用send，检查下位机收到的yaw严格递增，且最后一条指令一定被发出
+const std::string keys =
+  "{help h usage ? |     | 输出命令行参数说明          }"
+  "{duration d     | 3   | 测试时长(s)                 }"
+  "{garbage-every g| 10  | 每隔多少包插入一段错误数据  }"
+  "{seed           | 0   | 随机种子                    }";
+
+io::GimbalToVision make_packet(uint32_t seq)
+{
+  io::GimbalToVision packet{};
+  packet.head[0] = 'S';
+  packet.head[1] = 'P';
+  packet.mode = 1;
+  packet.q[0] = std::cos(seq * 1e-3);
+  packet.q[1] = 0;
+  packet.q[2] = 0;
+  packet.q[3] = std::sin(seq * 1e-3);
+  packet.yaw = seq;
+  packet.bullet_speed = 23;
+  packet.crc16 = tools::get_crc16(
+    reinterpret_cast<uint8_t *>(&packet), sizeof(packet) - sizeof(packet.crc16));
+  return packet;
+}
+
+void append(std::vector<uint8_t> & buffer, const void * data, std::size_t size)
+{
+  auto * bytes = static_cast<const uint8_t *>(data);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+bool write_all(int fd, const std::vector<uint8_t> & buffer)
+{
+  std::size_t written = 0;
+  while (written < buffer.size()) {
+    auto n = ::write(fd, buffer.data() + written, buffer.size() - written);
+    if (n < 0) return false;
+    written += n;
+  }
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto duration = cli.get<double>("duration");
+  auto garbage_every = cli.get<int>("garbage-every");
+  auto seed = cli.get<int>("seed");
+
+  int master, slave;
+  char name[256];
+  if (::openpty(&master, &slave, name, nullptr, nullptr) == -1) {
+    tools::logger()->error("openpty failed: {}", std::strerror(errno));
+    return 1;
+  }
+
+  // 关闭回显等行规程处理，slave保持打开，Gimbal重连时伪终端不会被挂断
+  termios tio;
+  ::tcgetattr(slave, &tio);
+  ::cfmakeraw(&tio);
+  ::tcsetattr(slave, TCSANOW, &tio);
+
+  auto config_path = fmt::format("/tmp/gimbal_serial_test_{}.yaml", ::getpid());
+  std::ofstream(config_path) << fmt::format("com_port: \"{}\"\n", name);
+
+  // 下位机发送
+  std::atomic<bool> quit{false};
+  std::atomic<uint32_t> valid{0};
+  std::size_t garbage_bytes = 0, injections = 0;
+  std::thread writer([&] {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> byte(0, 255), kind(0, 2), length(1, 64);
+    std::vector<uint8_t> buffer;
+    uint32_t seq = 0;
+
+    while (!quit) {
+      buffer.clear();
+      for (int i = 0; i < 8; i++) {
+        auto packet = make_packet(++seq);
+        append(buffer, &packet, sizeof(packet));
+
+        if (garbage_every <= 0 || seq % garbage_every != 0) continue;
+        auto begin = buffer.size();
+        auto bad = make_packet(0);
+        switch (kind(rng)) {
+          case 0:  // 随机字节，'S'和'P'出现得更频繁
+            for (int j = length(rng); j > 0; j--)
+              buffer.push_back(j % 3 == 0 ? "SP"[j % 2] : byte(rng));
+            break;
+          case 1:  // 截断的包
+            append(buffer, &bad, length(rng) % (sizeof(bad) - 2) + 2);
+            break;
+          case 2:  // CRC错误的包
+            reinterpret_cast<uint8_t *>(&bad)[length(rng) % (sizeof(bad) - 2) + 2] ^= 0x5a;
+            append(buffer, &bad, sizeof(bad));
+            break;
+        }
+        garbage_bytes += buffer.size() - begin;
+        injections++;
+      }
+
+      if (!write_all(master, buffer)) break;
+      valid = seq;
+    }
+  });
+
+  // 下位机接收
+  std::atomic<bool> stop{false};
+  io::PacketParser<io::VisionToGimbal> tx_parser;
+  std::vector<float> commands;
+  std::thread reader([&] {
+    while (!stop) {
+      pollfd fd{master, POLLIN, 0};
+      if (::poll(&fd, 1, 100) <= 0) continue;
+      auto n = ::read(master, tx_parser.write_ptr(), tx_parser.writable());
+      if (n <= 0) break;
+      tx_parser.commit(n);
+      tx_parser.parse([&](const io::VisionToGimbal & data) { commands.push_back(data.yaw); });
+    }
+  });
+
+  auto ok = true;
+  int sent = 0;
+  io::Gimbal::LinkStats tx;
+  {
+    io::Gimbal gimbal(config_path);
+
+    // 控制线程
+    double send_max = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    auto rx_begin = gimbal.link_stats().rx.packets;
+    while (tools::delta_time(std::chrono::steady_clock::now(), t0) < duration) {
+      auto t = std::chrono::steady_clock::now();
+      gimbal.send(true, false, ++sent, 0, 0, 0, 0, 0);
+      send_max = std::max(send_max, tools::delta_time(std::chrono::steady_clock::now(), t));
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    auto elapsed = tools::delta_time(std::chrono::steady_clock::now(), t0);
+    auto rx_end = gimbal.link_stats().rx.packets;
+
+    // 停止发送后等待剩余数据被读完
+    quit = true;
+    writer.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    auto stats = gimbal.link_stats();
+    auto state = gimbal.state();
+    tools::logger()->info(
+      "rx: {:.0f} packets/s, {} packets, {} crc errors, {} skipped bytes ({} garbage bytes in {} "
+      "injections)",
+      (rx_end - rx_begin) / elapsed, stats.rx.packets, stats.rx.crc_errors, stats.rx.skipped,
+      garbage_bytes, injections);
+    tools::logger()->info(
+      "tx: {} sent, {} overwritten, {} errors, send max {:.3f}ms", stats.tx_sent,
+      stats.tx_overwritten, stats.tx_errors, send_max * 1e3);
+
+    if (stats.rx.packets != valid) {
+      tools::logger()->error("{} of {} valid packets parsed!", stats.rx.packets, valid.load());
+      ok = false;
+    }
+    if (state.yaw != valid) {
+      tools::logger()->error("Latest packet {} not applied, got {}!", valid.load(), state.yaw);
+      ok = false;
+    }
+
+    tx = stats;
+  }
+
+  // Gimbal析构时发出最后一条指令
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  stop = true;
+  reader.join();
+
+  if (commands.empty() || commands.back() != sent) {
+    tools::logger()->error("Latest command {} was not sent!", sent);
+    ok = false;
+  }
+  for (std::size_t i = 1; i < commands.size(); i++) {
+    if (commands[i] > commands[i - 1]) continue;
+    tools::logger()->error("Commands out of order!");
+    ok = false;
+    break;
+  }
+  if (tx.tx_sent != commands.size() || tx.tx_sent + tx.tx_overwritten != sent) {
+    tools::logger()->error(
+      "tx counters mismatch: {} sent, {} overwritten, {} received by device, {} submitted",
+      tx.tx_sent, tx.tx_overwritten, commands.size(), sent);
+    ok = false;
+  }
+
+  ::close(master);
+  ::close(slave);
+  std::remove(config_path.c_str());
+
+  if (ok) tools::logger()->info("Gimbal serial test passed.");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <random>
+
+#include "tasks/auto_aim/yolos/small_nms.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |      | 输出命令行参数说明}"
+  "{repeat r       | 2000 | 每组重复次数      }"
+  "{scenes s       | 50   | 每种候选数的场景数}"
+  "{seed           | 0    | 随机种子          }";
+
+using Keypoints = std::array<cv::Point2f, 4>;
+
+struct Scene
+{
+  std::vector<cv::Rect> boxes;
+  std::vector<float> scores;
+  std::vector<int> class_ids;
+  std::vector<Keypoints> keypoints;
+};
+
+// 模拟模型输出：若干目标，每个目标周围聚集多个抖动的候选框
+Scene make_scene(int box_num, std::mt19937 & rng)
+{
+  std::uniform_real_distribution<float> center_x(0, 1280), center_y(0, 1024), size(20, 120);
+  std::uniform_real_distribution<float> jitter(-4, 4), score(0.71f, 1.0f);
+  std::uniform_int_distribution<int> class_id(0, 8);
+
+  Scene scene;
+  auto target_num = std::max(1, box_num / 8);
+  for (int i = 0; i < box_num; i++) {
+    // 同一目标的候选使用相同的随机状态生成中心和尺寸
+    std::mt19937 target_rng(i % target_num);
+    auto cx = center_x(target_rng), cy = center_y(target_rng);
+    auto w = size(target_rng), h = size(target_rng) * 0.5f;
+
+    cx += jitter(rng);
+    cy += jitter(rng);
+    cv::Rect box(cx - 0.5f * w, cy - 0.5f * h, w + jitter(rng), h + jitter(rng));
+
+    Keypoints keypoints = {
+      cv::Point2f(box.x, box.y), cv::Point2f(box.x + box.width, box.y),
+      cv::Point2f(box.x + box.width, box.y + box.height), cv::Point2f(box.x, box.y + box.height)};
+
+    scene.boxes.push_back(box);
+    scene.scores.push_back(score(rng));
+    scene.class_ids.push_back(class_id(rng));
+    scene.keypoints.push_back(keypoints);
+  }
+  return scene;
+}
+
+// 原有流程：每帧重新构造并行的vector，再调用cv::dnn::NMSBoxes
+std::size_t legacy(const Scene & scene, float iou_threshold, std::vector<int> & indices)
+{
+  std::vector<int> ids;
+  std::vector<float> confidences;
+  std::vector<cv::Rect> boxes;
+  std::vector<std::vector<cv::Point2f>> armors_key_points;
+  for (std::size_t i = 0; i < scene.boxes.size(); i++) {
+    ids.emplace_back(scene.class_ids[i]);
+    confidences.emplace_back(scene.scores[i]);
+    boxes.emplace_back(scene.boxes[i]);
+    armors_key_points.emplace_back(scene.keypoints[i].begin(), scene.keypoints[i].end());
+  }
+
+  cv::dnn::NMSBoxes(boxes, confidences, 0.7f, iou_threshold, indices);
+  return indices.size();
+}
+
+template <class Nms>
+int in_place(const Scene & scene, Nms & nms)
+{
+  nms.clear();
+  for (std::size_t i = 0; i < scene.boxes.size(); i++)
+    nms.push(scene.boxes[i], scene.scores[i], scene.class_ids[i], 0, scene.keypoints[i]);
+  nms.run();
+  return nms.kept_num();
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto repeat = std::max(1, cli.get<int>("repeat"));
+  auto scene_num = std::max(1, cli.get<int>("scenes"));
+  std::mt19937 rng(cli.get<int>("seed"));
+
+  constexpr float IOU_THRESHOLD = 0.3f;
+  constexpr int CAPACITY = 256;
+
+  // 不限制保留数时结果应与NMSBoxes完全一致
+  auto_aim::SmallNms<4, CAPACITY> nms({IOU_THRESHOLD, 0.7f, CAPACITY, false});
+  auto_aim::SmallNms<4, CAPACITY> capped_nms({IOU_THRESHOLD, 0.7f, 8, false});
+  auto_aim::SmallNms<4, CAPACITY> class_aware_nms({IOU_THRESHOLD, 0.7f, CAPACITY, true});
+
+  for (auto box_num : {4, 8, 16, 32, 64, 128, 256}) {
+    double legacy_sum = 0, small_sum = 0, capped_sum = 0, class_aware_sum = 0;
+    int mismatch = 0;
+    std::size_t kept_sum = 0, class_aware_kept_sum = 0;
+
+    for (int s = 0; s < scene_num; s++) {
+      auto scene = make_scene(box_num, rng);
+      std::vector<int> indices;
+
+      auto legacy_start = std::chrono::steady_clock::now();
+      for (int i = 0; i < repeat; i++) legacy(scene, IOU_THRESHOLD, indices);
+
+      auto small_start = std::chrono::steady_clock::now();
+      for (int i = 0; i < repeat; i++) in_place(scene, nms);
+
+      auto capped_start = std::chrono::steady_clock::now();
+      for (int i = 0; i < repeat; i++) in_place(scene, capped_nms);
+
+      auto class_aware_start = std::chrono::steady_clock::now();
+      for (int i = 0; i < repeat; i++) in_place(scene, class_aware_nms);
+
+      auto finish = std::chrono::steady_clock::now();
+      legacy_sum += tools::delta_time(small_start, legacy_start) * 1e6 / repeat;
+      small_sum += tools::delta_time(capped_start, small_start) * 1e6 / repeat;
+      capped_sum += tools::delta_time(class_aware_start, capped_start) * 1e6 / repeat;
+      class_aware_sum += tools::delta_time(finish, class_aware_start) * 1e6 / repeat;
+
+      // 保留的候选及其顺序应与NMSBoxes一致
+      auto same = static_cast<int>(indices.size()) == nms.kept_num();
+      for (int k = 0; same && k < nms.kept_num(); k++) same = indices[k] == nms.kept(k);
+      if (!same) mismatch++;
+
+      kept_sum += nms.kept_num();
+      class_aware_kept_sum += class_aware_nms.kept_num();
+    }
+
+    tools::logger()->info(
+      "{:3} boxes, NMSBoxes: {:.2f}us, small: {:.2f}us, capped(8): {:.2f}us, "
+      "class aware: {:.2f}us, kept: {:.1f}/{:.1f}, mismatch: {}/{}",
+      box_num, legacy_sum / scene_num, small_sum / scene_num, capped_sum / scene_num,
+      class_aware_sum / scene_num, static_cast<double>(kept_sum) / scene_num,
+      static_cast<double>(class_aware_kept_sum) / scene_num, mismatch, scene_num);
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "io/socketcan.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+// 在vcan上测量SocketCAN的接收吞吐和时间戳抖动，发送端把发送时刻写入数据段：
+//   kernel: 回调收到的内核时间戳 - 发送时刻
+//   user:   回调中的steady_clock::now() - 发送时刻(旧实现的打戳方式)
+// 准备vcan: sudo modprobe vcan && sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+const std::string keys =
+  "{help h usage ? |       | 输出命令行参数说明            }"
+  "{interface i    | vcan0 | CAN接口                       }"
+  "{frames n       | 20000 | 发送的帧数                    }"
+  "{rate r         | 1000  | 发送频率(Hz)，0为尽快发送     }";
+
+struct Stats
+{
+  double mean, stddev, p50, p99, max;
+};
+
+Stats stats(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  double sum = 0, sum2 = 0;
+  for (auto v : values) {
+    sum += v;
+    sum2 += v * v;
+  }
+  auto n = values.size();
+  auto mean = sum / n;
+  auto at = [&values](double p) { return values[static_cast<size_t>(p * (values.size() - 1))]; };
+  return {mean, std::sqrt(std::max(0.0, sum2 / n - mean * mean)), at(0.5), at(0.99), values.back()};
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto interface = cli.get<std::string>("interface");
+  auto frames = cli.get<int>("frames");
+  auto rate = cli.get<double>("rate");
+
+  std::vector<double> kernel_latency(frames), user_latency(frames);
+  std::vector<std::chrono::steady_clock::time_point> arrivals(frames);
+  std::atomic<int> received{0};
+
+  auto to_ns = [](std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+  };
+
+  io::SocketCAN receiver(interface, [&](const can_frame & frame, auto timestamp) {
+    auto now = std::chrono::steady_clock::now();
+    auto i = received.load();
+    if (i >= frames) return;
+
+    int64_t sent;
+    std::memcpy(&sent, frame.data, sizeof(sent));
+    kernel_latency[i] = (to_ns(timestamp) - sent) / 1e3;
+    user_latency[i] = (to_ns(now) - sent) / 1e3;
+    arrivals[i] = now;
+    received = i + 1;
+  });
+  io::SocketCAN sender(interface, [](const can_frame &, auto) {});
+
+  // 等待两个socket都打开
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  auto start = std::chrono::steady_clock::now();
+  auto busy = 0;
+  for (int i = 0; i < frames; i++) {
+    if (rate > 0) std::this_thread::sleep_until(start + std::chrono::duration<double>(i / rate));
+
+    can_frame frame{};
+    frame.can_id = 0x100;
+    frame.can_dlc = 8;
+    auto sent = to_ns(std::chrono::steady_clock::now());
+    std::memcpy(frame.data, &sent, sizeof(sent));
+
+    // 尽快发送时vcan的发送队列会满(ENOBUFS)，稍后重试，持续失败说明接口不可用
+    auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (true) {
+      try {
+        sender.write(&frame);
+        break;
+      } catch (const std::exception & e) {
+        if (std::chrono::steady_clock::now() > give_up) {
+          tools::logger()->error("{} Is {} up?", e.what(), interface);
+          return 1;
+        }
+        busy++;
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+      }
+    }
+  }
+
+  // 最多再等1s接收剩余的帧
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (received < frames && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  auto n = received.load();
+  if (n < 2) {
+    tools::logger()->error("Received {} frames. Is {} up?", n, interface);
+    return 1;
+  }
+
+  kernel_latency.resize(n);
+  user_latency.resize(n);
+  auto elapsed = tools::delta_time(arrivals[n - 1], arrivals[0]);
+
+  tools::logger()->info(
+    "{}: sent {}, received {}, lost {}, tx busy retries {}", interface, frames, n, frames - n,
+    busy);
+  tools::logger()->info("throughput: {:.0f} frames/s", (n - 1) / elapsed);
+
+  auto report = [](const std::string & name, const std::vector<double> & values) {
+    auto s = stats(values);
+    tools::logger()->info(
+      "{} timestamp - send time: mean {:.1f}us, stddev {:.1f}us, p50 {:.1f}us, p99 {:.1f}us, "
+      "max {:.1f}us",
+      name, s.mean, s.stddev, s.p50, s.p99, s.max);
+  };
+  report("kernel", kernel_latency);
+  report("  user", user_latency);
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <fmt/core.h>
+#include <yaml-cpp/yaml.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <opencv2/opencv.hpp>
+
+#include "tasks/auto_aim/yolo.hpp"
+#include "tasks/auto_aim/yolos/infer_pool.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+// 统计全局operator new与cv::Mat的分配次数，用于检查稳态下的堆分配
+static std::atomic<std::size_t> allocations{0};
+
+void * operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void * ptr) noexcept { std::free(ptr); }
+
+void operator delete(void * ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void * ptr, std::size_t) noexcept { std::free(ptr); }
+
+// cv::Mat的内存不经过operator new，用默认分配器的包装统计
+class CountingAllocator : public cv::MatAllocator
+{
+public:
+  cv::UMatData * allocate(
+    int dims, const int * sizes, int type, void * data, size_t * step, cv::AccessFlag flags,
+    cv::UMatUsageFlags usage_flags) const override
+  {
+    if (!data) allocations.fetch_add(1, std::memory_order_relaxed);
+    return std_->allocate(dims, sizes, type, data, step, flags, usage_flags);
+  }
+
+  bool allocate(
+    cv::UMatData * u, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override
+  {
+    return std_->allocate(u, flags, usage_flags);
+  }
+
+  void deallocate(cv::UMatData * u) const override { std_->deallocate(u); }
+
+private:
+  cv::MatAllocator * std_ = cv::Mat::getStdAllocator();
+};
+
+const std::string keys =
+  "{help h usage ? |                       | 输出命令行参数说明 }"
+  "{config-path c  | configs/demo.yaml     | yaml配置文件的路径}"
+  "{@video_path    | assets/demo/demo.avi  | avi路径}";
+
+// 原有流程：每帧新建并清零输入图像，新建推理请求
+void legacy(const ov::CompiledModel & compiled_model, const cv::Mat & bgr_img, int input_size)
+{
+  auto x_scale = static_cast<double>(input_size) / bgr_img.rows;
+  auto y_scale = static_cast<double>(input_size) / bgr_img.cols;
+  auto scale = std::min(x_scale, y_scale);
+  auto h = static_cast<int>(bgr_img.rows * scale);
+  auto w = static_cast<int>(bgr_img.cols * scale);
+
+  auto input = cv::Mat(input_size, input_size, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::resize(bgr_img, input(cv::Rect(0, 0, w, h)), {w, h});
+  auto input_dim = static_cast<std::size_t>(input_size);
+  ov::Tensor input_tensor(ov::element::u8, {1, input_dim, input_dim, 3}, input.data);
+
+  auto infer_request = compiled_model.create_infer_request();
+  infer_request.set_input_tensor(input_tensor);
+  infer_request.infer();
+}
+
+int main(int argc, char * argv[])
+{
+  // 读取命令行参数
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto video_path = cli.get<std::string>(0);
+  auto config_path = cli.get<std::string>("config-path");
+
+  CountingAllocator counting_allocator;
+  cv::Mat::setDefaultAllocator(&counting_allocator);
+
+  auto yaml = YAML::LoadFile(config_path);
+  auto yolo_name = yaml["yolo_name"].as<std::string>();
+
+  auto model_key = yolo_name + "_model_path";
+  auto latency = ov::hint::PerformanceMode::LATENCY;
+  auto_aim::InferPool pool(
+    config_path, model_key, 1, latency, auto_aim::InferPool::Preprocess::cpu);
+  auto_aim::InferPool ov_pool(
+    config_path, model_key, 1, latency, auto_aim::InferPool::Preprocess::ov);
+  auto input_size = pool.input_size();
+  auto_aim::YOLO yolo(config_path, false);
+
+  cv::VideoCapture video(video_path);
+  if (!video.isOpened()) {
+    tools::logger()->error("Failed to open {}", video_path);
+    return 1;
+  }
+
+  double legacy_sum = 0, pool_sum = 0, ov_sum = 0, detect_sum = 0;
+  std::size_t legacy_allocs = 0, pool_allocs = 0, ov_allocs = 0, detect_allocs = 0;
+  double max_diff = 0;
+  int frames = 0;
+
+  for (cv::Mat img; video.read(img) && !img.empty(); frames++) {
+    // 第一帧用于预热，不计入统计
+    if (frames == 0) {
+      legacy(pool.compiled_model(), img, input_size);
+      double scale;
+      pool.infer(img, scale);
+      ov_pool.infer(img, scale);
+      yolo.detect(img, frames);
+      continue;
+    }
+
+    auto legacy_start = std::chrono::steady_clock::now();
+    auto legacy_allocs_start = allocations.load();
+    legacy(pool.compiled_model(), img, input_size);
+
+    auto pool_start = std::chrono::steady_clock::now();
+    auto pool_allocs_start = allocations.load();
+    double scale;
+    auto output = pool.infer(img, scale);
+
+    auto ov_start = std::chrono::steady_clock::now();
+    auto ov_allocs_start = allocations.load();
+    auto ov_output = ov_pool.infer(img, scale);
+
+    auto detect_start = std::chrono::steady_clock::now();
+    auto detect_allocs_start = allocations.load();
+    auto armors = yolo.detect(img, frames);
+
+    auto finish = std::chrono::steady_clock::now();
+    auto finish_allocs = allocations.load();
+
+    legacy_sum += tools::delta_time(pool_start, legacy_start) * 1e3;
+    pool_sum += tools::delta_time(ov_start, pool_start) * 1e3;
+    ov_sum += tools::delta_time(detect_start, ov_start) * 1e3;
+    detect_sum += tools::delta_time(finish, detect_start) * 1e3;
+    legacy_allocs += pool_allocs_start - legacy_allocs_start;
+    pool_allocs += ov_allocs_start - pool_allocs_start;
+    ov_allocs += detect_allocs_start - ov_allocs_start;
+
+    // 两种预处理的插值实现不同，输出只能近似一致
+    max_diff = std::max(max_diff, cv::norm(output, ov_output, cv::NORM_INF));
+    detect_allocs += finish_allocs - detect_allocs_start;
+  }
+
+  if (frames < 2) return 1;
+
+  auto n = frames - 1;
+  tools::logger()->info("{} {}x{}, {} frames", yolo_name, input_size, input_size, n);
+  tools::logger()->info(
+    "legacy preprocess + infer: {:.2f}ms/frame, {:.1f} allocs/frame", legacy_sum / n,
+    static_cast<double>(legacy_allocs) / n);
+  tools::logger()->info(
+    "pool preprocess + infer: {:.2f}ms/frame, {:.1f} allocs/frame", pool_sum / n,
+    static_cast<double>(pool_allocs) / n);
+  tools::logger()->info(
+    "ov preprocess + infer: {:.2f}ms/frame, {:.1f} allocs/frame, max output diff: {:.3f}",
+    ov_sum / n, static_cast<double>(ov_allocs) / n, max_diff);
+  tools::logger()->info(
+    "YOLO::detect: {:.2f}ms/frame, {:.1f} allocs/frame", detect_sum / n,
+    static_cast<double>(detect_allocs) / n);
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include "attitude_history.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace tools
+{
+AttitudeHistory::AttitudeHistory(std::size_t capacity, double max_extrapolation)
+: max_extrapolation_(max_extrapolation)
+{
+  // 容量向上取整为2的幂，用掩码代替取模
+  std::size_t size = 2;
+  while (size < capacity) size <<= 1;
+
+  mask_ = size - 1;
+  slots_ = std::make_unique<Slot[]>(size);
+}
+
+void AttitudeHistory::push(std::chrono::steady_clock::time_point t, const Eigen::Quaterniond & q)
+{
+  write(t.time_since_epoch().count(), q, nullptr);
+}
+
+void AttitudeHistory::push(
+  std::chrono::steady_clock::time_point t, const Eigen::Quaterniond & q,
+  const Eigen::Vector3d & gyro)
+{
+  write(t.time_since_epoch().count(), q, &gyro);
+}
+
+Eigen::Quaterniond AttitudeHistory::at(std::chrono::steady_clock::time_point timestamp) const
+{
+  auto t = timestamp.time_since_epoch().count();
+
+  // 读取的样本在查询过程中被覆盖(读者落后整整一圈)时从头重试
+  while (true) {
+    auto head = head_.load(std::memory_order_acquire);
+    auto capacity = static_cast<uint64_t>(mask_ + 1);
+    auto oldest = head > capacity ? head - capacity : 0;
+    auto begin = std::max(begin_.load(std::memory_order_acquire), oldest);
+    if (head <= begin) return Eigen::Quaterniond::Identity();
+
+    Sample last;
+    if (!read(head - 1, last)) continue;
+
+    // 没有陀螺仪数据时用最后两个样本的差分估计角速度
+    if (t >= last.t) {
+      if (last.has_gyro) return extrapolate(last, last.gyro, t);
+      if (head - 1 == begin) return last.q;
+
+      Sample prev;
+      if (!read(head - 2, prev)) continue;
+      Eigen::Quaterniond dq = prev.q.conjugate() * last.q;
+      if (dq.w() < 0) dq.coeffs() = -dq.coeffs();  // 取最短路径
+
+      Eigen::AngleAxisd delta(dq);
+      auto dt = std::chrono::duration<double>(std::chrono::steady_clock::duration(last.t - prev.t));
+      return extrapolate(last, delta.axis() * delta.angle() / dt.count(), t);
+    }
+
+    // 找到第一个晚于t的样本，被覆盖的槽位一定是最旧的，视为早于t
+    auto lo = begin, hi = head - 1;
+    while (lo < hi) {
+      auto mid = lo + (hi - lo) / 2;
+      Sample sample;
+      if (!read(mid, sample) || sample.t <= t)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    Sample a, b;
+    if (!read(hi, b)) continue;
+    if (hi == begin) return b.q;
+    if (!read(hi - 1, a)) continue;
+
+    // 四元数插值
+    auto k = static_cast<double>(t - a.t) / (b.t - a.t);
+    return a.q.slerp(k, b.q).normalized();
+  }
+}
+
+std::size_t AttitudeHistory::size() const
+{
+  auto head = head_.load(std::memory_order_acquire);
+  auto begin = begin_.load(std::memory_order_acquire);
+  return std::min<uint64_t>(head - std::min(begin, head), mask_ + 1);
+}
+
+void AttitudeHistory::wait(std::size_t count) const
+{
+  while (size() < count) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void AttitudeHistory::clear()
+{
+  begin_.store(head_.load(std::memory_order_relaxed), std::memory_order_release);
+  last_t_ = 0;
+}
+
+void AttitudeHistory::write(int64_t t, const Eigen::Quaterniond & q, const Eigen::Vector3d * gyro)
+{
+  auto n = head_.load(std::memory_order_relaxed);
+  if (t <= last_t_) return;
+  last_t_ = t;
+
+  Eigen::Quaterniond q_normalized = q.normalized();
+  auto & slot = slots_[n & mask_];
+
+  slot.version.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.t.store(t, std::memory_order_relaxed);
+  slot.q[0].store(q_normalized.w(), std::memory_order_relaxed);
+  slot.q[1].store(q_normalized.x(), std::memory_order_relaxed);
+  slot.q[2].store(q_normalized.y(), std::memory_order_relaxed);
+  slot.q[3].store(q_normalized.z(), std::memory_order_relaxed);
+  slot.has_gyro.store(gyro != nullptr, std::memory_order_relaxed);
+  if (gyro != nullptr)
+    for (int i = 0; i < 3; i++) slot.gyro[i].store((*gyro)[i], std::memory_order_relaxed);
+
+  slot.version.store(2 * n + 2, std::memory_order_release);
+  head_.store(n + 1, std::memory_order_release);
+}
+
+bool AttitudeHistory::read(uint64_t n, Sample & sample) const
+{
+  const auto & slot = slots_[n & mask_];
+
+  auto version = slot.version.load(std::memory_order_acquire);
+  if (version != 2 * n + 2) return false;
+
+  sample.t = slot.t.load(std::memory_order_relaxed);
+  sample.q.w() = slot.q[0].load(std::memory_order_relaxed);
+  sample.q.x() = slot.q[1].load(std::memory_order_relaxed);
+  sample.q.y() = slot.q[2].load(std::memory_order_relaxed);
+  sample.q.z() = slot.q[3].load(std::memory_order_relaxed);
+  sample.has_gyro = slot.has_gyro.load(std::memory_order_relaxed);
+  if (sample.has_gyro)
+    for (int i = 0; i < 3; i++) sample.gyro[i] = slot.gyro[i].load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.version.load(std::memory_order_relaxed) == version;
+}
+
+Eigen::Quaterniond AttitudeHistory::extrapolate(
+  const Sample & last, const Eigen::Vector3d & gyro, int64_t t) const
+{
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::duration(t - last.t));
+  auto dt = std::min(elapsed.count(), max_extrapolation_);
+
+  auto angle = gyro.norm() * dt;
+  if (angle < 1e-12) return last.q;
+  return (last.q * Eigen::Quaterniond(Eigen::AngleAxisd(angle, gyro.normalized()))).normalized();
+}
+
+}  // namespace tools
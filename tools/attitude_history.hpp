@@ -0,0 +1,80 @@
+#ifndef TOOLS__ATTITUDE_HISTORY_HPP
+#define TOOLS__ATTITUDE_HISTORY_HPP
+
+#include <Eigen/Geometry>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tools
+{
+// 带时间戳的姿态环形缓冲区，一个线程写入，任意多个线程并发查询
+// 每个槽位用seqlock保护：读者不加锁、不阻塞写者，读到正在被覆盖的槽位时重试
+// 查询不消耗数据，同一时刻或更早的时刻可以反复查询
+class AttitudeHistory
+{
+public:
+  // capacity向上取整为2的幂；t超出最新样本时最多外推max_extrapolation(s)
+  explicit AttitudeHistory(std::size_t capacity = 1024, double max_extrapolation = 0.01);
+
+  // 仅限写入线程调用，时间戳不增的样本被丢弃
+  void push(std::chrono::steady_clock::time_point t, const Eigen::Quaterniond & q);
+
+  // gyro为机体系角速度，单位：rad/s，用于外推
+  void push(
+    std::chrono::steady_clock::time_point t, const Eigen::Quaterniond & q,
+    const Eigen::Vector3d & gyro);
+
+  // 时刻t的姿态，O(log n)二分查找后球面插值，不阻塞
+  // t晚于最新样本时按角速度外推(没有陀螺仪数据时用最后两个样本估计)，早于最旧样本时返回最旧样本
+  // 没有样本时返回单位四元数
+  Eigen::Quaterniond at(std::chrono::steady_clock::time_point t) const;
+
+  // 当前可查询的样本数
+  std::size_t size() const;
+
+  // 等待至少count个样本，用于构造时等待第一帧数据
+  void wait(std::size_t count) const;
+
+  // 仅限写入线程调用，丢弃所有样本，用于重连后
+  void clear();
+
+private:
+  struct Sample
+  {
+    int64_t t;  // steady_clock的计数
+    Eigen::Quaterniond q;
+    Eigen::Vector3d gyro;
+    bool has_gyro;
+  };
+
+  // 字段均为原子变量，读者与写者并发访问不构成数据竞争
+  struct alignas(64) Slot
+  {
+    std::atomic<uint64_t> version{0};  // 写入第n个样本时为2n+1，写完为2n+2
+    std::atomic<int64_t> t{0};
+    std::atomic<double> q[4];
+    std::atomic<double> gyro[3];
+    std::atomic<bool> has_gyro{false};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t mask_;
+  double max_extrapolation_;
+
+  std::atomic<uint64_t> head_{0};   // 已写入的样本数
+  std::atomic<uint64_t> begin_{0};  // clear之后第一个有效样本的序号
+  int64_t last_t_ = 0;              // 写入线程私有，steady_clock的计数总为正
+
+  void write(int64_t t, const Eigen::Quaterniond & q, const Eigen::Vector3d * gyro);
+  bool read(uint64_t n, Sample & sample) const;
+  // 从last出发按机体系角速度gyro外推到t，外推时长不超过max_extrapolation_
+  Eigen::Quaterniond extrapolate(
+    const Sample & last, const Eigen::Vector3d & gyro, int64_t t) const;
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__ATTITUDE_HISTORY_HPP
@@ -0,0 +1,123 @@
+#include "clock_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "logger.hpp"
+
+namespace tools
+{
+// 样本太少时斜率不可靠
+constexpr std::size_t MIN_SAMPLES = 10;
+
+ClockModel::ClockModel(std::size_t window, double max_jump)
+: window_(std::max(window, MIN_SAMPLES)), max_jump_(max_jump)
+{
+}
+
+std::chrono::steady_clock::time_point ClockModel::update(
+  double device_time, std::chrono::steady_clock::time_point host)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!samples_.empty()) {
+    auto x = device_time - device_base_;
+    auto y = std::chrono::duration<double>(host - host_base_).count();
+    auto error = ready() ? y - (intercept_ + slope_ * x) : 0.0;
+
+    // 收到时刻早于模型给出的曝光时刻，只可能是设备时钟发生了跳变
+    // 连续多帧大幅滞后同样说明模型已失效
+    if (x <= samples_.back().device || error < -max_jump_ || late_ >= MIN_SAMPLES) {
+      logger()->warn("[ClockModel] Device clock jumped, reset.");
+      clear();
+      resets_++;
+    }
+
+    // 帧在SDK中积压后才取出，收到时刻不代表传输延迟，不参与拟合
+    else if (error > max_jump_) {
+      late_++;
+      auto mapped = std::chrono::duration<double>(intercept_ + slope_ * x);
+      return host_base_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(mapped);
+    }
+  }
+
+  late_ = 0;
+
+  if (samples_.empty()) {
+    device_base_ = device_time;
+    host_base_ = host;
+  }
+
+  auto x = device_time - device_base_;
+  auto y = std::chrono::duration<double>(host - host_base_).count();
+  samples_.push_back({x, y});
+  if (samples_.size() > window_) samples_.pop_front();
+
+  if (!ready()) return host;
+
+  fit();
+  auto mapped = std::chrono::duration<double>(intercept_ + slope_ * x);
+  return host_base_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(mapped);
+}
+
+ClockModel::Metrics ClockModel::metrics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!ready()) return {0, 0, 0, samples_.size(), resets_};
+
+  auto x = samples_.back().device;
+  auto host = std::chrono::duration<double>(host_base_.time_since_epoch()).count() + intercept_ +
+              slope_ * x;
+  auto device = device_base_ + x;
+  return {host - device, (1 / slope_ - 1) * 1e6, residual_, samples_.size(), resets_};
+}
+
+void ClockModel::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  clear();
+}
+
+bool ClockModel::ready() const { return samples_.size() >= MIN_SAMPLES; }
+
+void ClockModel::fit()
+{
+  // 以均值为中心计算，避免运行时间变长后的精度损失
+  double mx = 0, my = 0;
+  for (const auto & s : samples_) {
+    mx += s.device;
+    my += s.host;
+  }
+  mx /= samples_.size();
+  my /= samples_.size();
+
+  double sxx = 0, sxy = 0;
+  for (const auto & s : samples_) {
+    sxx += (s.device - mx) * (s.device - mx);
+    sxy += (s.device - mx) * (s.host - my);
+  }
+  slope_ = sxx > 0 ? sxy / sxx : 1.0;
+
+  // 传输延迟总是正的，下包络比最小二乘的截距更接近真实的曝光时刻
+  double sum = 0;
+  auto lower = std::numeric_limits<double>::max();
+  for (const auto & s : samples_) {
+    auto r = s.host - (my + slope_ * (s.device - mx));
+    sum += r * r;
+    lower = std::min(lower, r);
+  }
+  residual_ = std::sqrt(sum / samples_.size());
+  intercept_ = my - slope_ * mx + lower;
+}
+
+void ClockModel::clear()
+{
+  samples_.clear();
+  late_ = 0;
+  slope_ = 1;
+  intercept_ = 0;
+  residual_ = 0;
+}
+
+}  // namespace tools
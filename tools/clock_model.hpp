@@ -0,0 +1,66 @@
+#ifndef TOOLS__CLOCK_MODEL_HPP
+#define TOOLS__CLOCK_MODEL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace tools
+{
+// 设备时钟到steady_clock的在线线性模型：host = offset + (1 + drift) * device
+// 用最近window个(设备时间戳, 主机收到帧的时刻)样本最小二乘拟合斜率，
+// 截距取样本的下包络，即只保留最小的传输延迟，去掉传输和取图循环带来的抖动
+class ClockModel
+{
+public:
+  struct Metrics
+  {
+    double offset;        // 最新样本处主机时间减去设备时间，单位：s
+    double drift;         // 设备时钟相对主机时钟的漂移，单位：ppm
+    double residual;      // 收到时刻相对拟合直线的均方根残差，单位：s
+    std::size_t samples;  // 窗口内的样本数
+    std::size_t resets;   // 设备时钟跳变(重连、溢出)导致的重置次数
+  };
+
+  explicit ClockModel(std::size_t window = 1000, double max_jump = 0.1);
+
+  // device_time为设备时间戳，单位：s；host为主机收到该帧的时刻
+  // 返回设备时间戳对应的主机时刻，样本不足时直接返回host
+  // 设备时间倒退或收到时刻比模型提前超过max_jump(s)时重新开始拟合，
+  // 滞后超过max_jump的样本不参与拟合
+  std::chrono::steady_clock::time_point update(
+    double device_time, std::chrono::steady_clock::time_point host);
+
+  Metrics metrics() const;
+
+  void reset();
+
+private:
+  struct Sample
+  {
+    double device;  // 相对第一个样本，单位：s
+    double host;
+  };
+
+  std::size_t window_;
+  double max_jump_;
+
+  mutable std::mutex mutex_;
+  std::deque<Sample> samples_;
+  double device_base_ = 0;
+  std::chrono::steady_clock::time_point host_base_;
+
+  // 相对第一个样本：host = intercept + slope * device
+  double slope_ = 1, intercept_ = 0, residual_ = 0;
+  std::size_t resets_ = 0;
+  std::size_t late_ = 0;  // 连续不参与拟合的样本数
+
+  bool ready() const;
+  void fit();
+  void clear();
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__CLOCK_MODEL_HPP
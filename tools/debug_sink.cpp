@@ -0,0 +1,181 @@
+#include "debug_sink.hpp"
+
+#include <arpa/inet.h>     // htons, inet_addr
+#include <sys/resource.h>  // setpriority
+#include <sys/socket.h>    // socket, sendto
+#include <sys/syscall.h>   // SYS_gettid
+#include <unistd.h>        // close, syscall
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "tools/logger.hpp"
+#include "tools/yaml.hpp"
+
+namespace tools
+{
+constexpr std::size_t MAX_CHUNK_SIZE = 60000;  // 单个udp包不超过64KB
+
+DebugSink::DebugSink(const std::string & config_path)
+{
+  auto yaml = tools::load(config_path);
+
+  // 未配置时关闭，无显示器的机器人上不会打开窗口
+  auto mode = yaml["debug_sink"].IsDefined() ? yaml["debug_sink"].as<std::string>() : "off";
+  auto fps = yaml["debug_sink_fps"].IsDefined() ? yaml["debug_sink_fps"].as<double>() : 15.0;
+  scale_ = yaml["debug_sink_scale"].IsDefined() ? yaml["debug_sink_scale"].as<double>() : 0.5;
+  jpg_quality_ = yaml["debug_sink_quality"].IsDefined() ? yaml["debug_sink_quality"].as<int>() : 80;
+  min_interval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / fps));
+
+  if (mode == "off") {
+    mode_ = Mode::off;
+    return;
+  }
+
+  // 窗口在调用线程中同步显示，不需要后台线程
+  if (mode == "window") {
+    mode_ = Mode::window;
+    return;
+  }
+
+  if (mode != "udp") throw std::runtime_error("Unknown debug_sink: " + mode + "!");
+
+  auto host = yaml["debug_sink_host"].IsDefined() ? yaml["debug_sink_host"].as<std::string>()
+                                                  : "127.0.0.1";
+  auto port = yaml["debug_sink_port"].IsDefined() ? yaml["debug_sink_port"].as<int>() : 9871;
+
+  socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) {
+    tools::logger()->error(
+      "[DebugSink] Failed to create socket: {}, turn off.", std::strerror(errno));
+    mode_ = Mode::off;
+    return;
+  }
+
+  mode_ = Mode::udp;
+  destination_.sin_family = AF_INET;
+  destination_.sin_port = ::htons(port);
+  destination_.sin_addr.s_addr = ::inet_addr(host.c_str());
+  drawing_thread_ = std::thread(&DebugSink::draw_loop, this);
+}
+
+DebugSink::~DebugSink()
+{
+  quit_ = true;
+  condition_.notify_all();
+  if (drawing_thread_.joinable()) drawing_thread_.join();
+  if (socket_ >= 0) ::close(socket_);
+}
+
+bool DebugSink::ready(const std::string & name)
+{
+  if (mode_ == Mode::off) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = last_submit_.find(name);
+  return it == last_submit_.end() ||
+         std::chrono::steady_clock::now() - it->second >= min_interval_;
+}
+
+void DebugSink::submit(const std::string & name, const cv::Mat & img, Drawer draw)
+{
+  if (mode_ == Mode::off || img.empty()) return;
+
+  auto now = std::chrono::steady_clock::now();
+
+  if (mode_ == Mode::window) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (window_thread_ == std::thread::id()) window_thread_ = std::this_thread::get_id();
+
+      // cv::imshow与cv::waitKey须在同一线程，其他线程的画面直接丢弃
+      if (window_thread_ != std::this_thread::get_id()) {
+        if (!warned_)
+          tools::logger()->warn("[DebugSink] Window mode is single-threaded, drop {}.", name);
+        warned_ = true;
+        return;
+      }
+      last_submit_[name] = now;
+    }
+    show(name, img, draw);
+    return;
+  }
+
+  // 在调用线程中拷贝，调用者返回后可能继续在img上绘制
+  auto snapshot = Snapshot{img.clone(), std::move(draw)};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_submit_[name] = now;
+    pending_[name] = std::move(snapshot);  // 未处理的旧帧直接被覆盖
+  }
+  condition_.notify_one();
+}
+
+void DebugSink::draw_loop()
+{
+  // 降低本线程优先级，避免与检测线程争抢CPU
+  ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+
+  while (!quit_) {
+    std::unordered_map<std::string, Snapshot> snapshots;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return quit_ || !pending_.empty(); });
+      snapshots.swap(pending_);
+    }
+
+    for (auto & [name, snapshot] : snapshots) {
+      auto & canvas = snapshot.img;
+      if (snapshot.draw) snapshot.draw(canvas);
+      if (scale_ != 1.0) cv::resize(canvas, canvas, {}, scale_, scale_);  // 缩小图片尺寸
+      send(name, canvas);
+    }
+  }
+}
+
+void DebugSink::show(const std::string & name, const cv::Mat & img, const Drawer & draw)
+{
+  // 只在需要绘制时拷贝，不修改调用者的img
+  auto canvas = draw ? img.clone() : img;
+  if (draw) draw(canvas);
+  if (scale_ != 1.0) cv::resize(canvas, canvas, {}, scale_, scale_);  // 缩小图片尺寸
+  cv::imshow(name, canvas);
+}
+
+void DebugSink::send(const std::string & name, const cv::Mat & canvas)
+{
+  std::vector<uchar> jpg;
+  if (!cv::imencode(".jpg", canvas, jpg, {cv::IMWRITE_JPEG_QUALITY, jpg_quality_})) {
+    tools::logger()->warn("[DebugSink] Failed to encode {}", name);
+    return;
+  }
+
+  PacketHeader header;
+  header.frame_id = frame_id_++;
+  header.chunk_num = static_cast<uint16_t>((jpg.size() + MAX_CHUNK_SIZE - 1) / MAX_CHUNK_SIZE);
+  std::strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+  header.name[sizeof(header.name) - 1] = '\0';
+
+  std::vector<uchar> packet(sizeof(header) + MAX_CHUNK_SIZE);
+  for (uint16_t i = 0; i < header.chunk_num; i++) {
+    auto begin = i * MAX_CHUNK_SIZE;
+    auto size = std::min(MAX_CHUNK_SIZE, jpg.size() - begin);
+
+    header.chunk_id = i;
+    std::memcpy(packet.data(), &header, sizeof(header));
+    std::memcpy(packet.data() + sizeof(header), jpg.data() + begin, size);
+    ::sendto(
+      socket_, packet.data(), sizeof(header) + size, 0,
+      reinterpret_cast<sockaddr *>(&destination_), sizeof(destination_));
+  }
+}
+
+DebugSink & debug_sink(const std::string & config_path)
+{
+  static DebugSink sink(config_path);
+  return sink;
+}
+
+}  // namespace tools
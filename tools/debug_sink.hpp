@@ -0,0 +1,96 @@
+#ifndef TOOLS__DEBUG_SINK_HPP
+#define TOOLS__DEBUG_SINK_HPP
+
+#include <netinet/in.h>  // sockaddr_in
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace tools
+{
+// 调试画面输出，yaml中debug_sink可选，未配置时为off：
+//   off:    关闭，ready()恒为false，无额外开销
+//   window: 本地窗口，在调用线程中同步绘制并cv::imshow，只能由一个线程使用，
+//           用于检测与cv::waitKey在同一线程的单线程调试工具
+//   udp:    jpg按debug_sink_fps限速，分片发送至debug_sink_host:debug_sink_port，
+//           绘制与编码在低优先级的后台线程完成，每个窗口只保留最新一帧
+// 整个进程共用一个实例，通过tools::debug_sink()获取
+class DebugSink
+{
+public:
+  using Drawer = std::function<void(cv::Mat &)>;
+
+  explicit DebugSink(const std::string & config_path);
+
+  ~DebugSink();
+
+  DebugSink(const DebugSink &) = delete;
+  DebugSink & operator=(const DebugSink &) = delete;
+
+  // 检测线程先调用ready()，为false时跳过快照拷贝
+  bool ready(const std::string & name);
+
+  // udp模式下拷贝img，调用者之后可以继续修改img；draw捕获检测结果的副本，在拷贝上绘制
+  void submit(const std::string & name, const cv::Mat & img, Drawer draw = {});
+
+private:
+  enum class Mode
+  {
+    off,
+    window,
+    udp
+  };
+
+  struct Snapshot
+  {
+    cv::Mat img;
+    Drawer draw;
+  };
+
+  // udp分片头，接收端按frame_id拼接chunk_num个分片后解码jpg
+  struct __attribute__((packed)) PacketHeader
+  {
+    uint8_t head[2] = {'D', 'S'};
+    uint32_t frame_id;
+    uint16_t chunk_id;
+    uint16_t chunk_num;
+    char name[16];
+  };
+
+  Mode mode_;
+  double scale_;
+  int jpg_quality_;
+  std::chrono::steady_clock::duration min_interval_;
+
+  int socket_ = -1;
+  sockaddr_in destination_;
+  uint32_t frame_id_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::unordered_map<std::string, Snapshot> pending_;
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point> last_submit_;
+
+  std::atomic<bool> quit_{false};
+  std::thread drawing_thread_;
+  std::thread::id window_thread_;  // window模式下第一个调用submit的线程
+  bool warned_ = false;
+
+  void draw_loop();
+  void show(const std::string & name, const cv::Mat & img, const Drawer & draw);
+  void send(const std::string & name, const cv::Mat & canvas);
+};
+
+// 进程内唯一的DebugSink，第一次调用时按config_path创建，之后的config_path被忽略
+DebugSink & debug_sink(const std::string & config_path);
+
+}  // namespace tools
+
+#endif  // TOOLS__DEBUG_SINK_HPP
@@ -0,0 +1,180 @@
+#include "frame_pool.hpp"
+
+#include <sys/mman.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+
+namespace tools
+{
+namespace
+{
+constexpr std::size_t PAGE_BYTES = 4096;
+constexpr std::size_t HUGE_PAGE_BYTES = 2 << 20;
+
+std::size_t align(std::size_t n, std::size_t alignment)
+{
+  return (n + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+// 一次性映射的连续内存，按页对齐切分为size块
+struct FramePool::Region
+{
+  std::size_t bytes;   // 每帧的有效字节数
+  std::size_t stride;  // 相邻缓冲区的间隔
+  std::size_t length;
+  uchar * base;
+
+  std::mutex mutex;
+  std::size_t size;
+  std::size_t fresh = 0;      // 从未取出过的缓冲区从base + fresh * stride开始
+  std::vector<uchar *> free;  // 已归还的缓冲区
+  std::atomic<std::size_t> in_use{0};
+
+  Region(std::size_t size, std::size_t bytes, bool hugepage)
+  : bytes(bytes), stride(align(bytes, PAGE_BYTES)), size(size)
+  {
+    length = align(stride * size, hugepage ? HUGE_PAGE_BYTES : PAGE_BYTES);
+    free.reserve(size);
+
+    // MAP_POPULATE提前完成缺页，采集线程第一次写入时不再陷入内核
+    auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE;
+    void * data = MAP_FAILED;
+    std::string kind = "normal pages";
+
+    if (hugepage) {
+      data = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+      kind = "hugetlb";
+    }
+
+    if (data == MAP_FAILED) {
+      data = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (data != MAP_FAILED && hugepage && madvise(data, length, MADV_HUGEPAGE) == 0)
+        kind = "transparent hugepages";
+      else
+        kind = "normal pages";
+    }
+
+    if (data == MAP_FAILED) throw std::runtime_error("FramePool mmap failed!");
+    base = static_cast<uchar *>(data);
+
+    tools::logger()->info(
+      "[FramePool] {} buffers of {} bytes, {:.1f}MB on {}", size, bytes, length / 1048576.0, kind);
+  }
+
+  ~Region() { munmap(base, length); }
+
+  uchar * take(bool & reused)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    reused = !free.empty();
+
+    uchar * data = nullptr;
+    if (reused) {
+      data = free.back();
+      free.pop_back();
+    } else if (fresh < size) {
+      data = base + fresh * stride;
+      fresh++;
+    }
+
+    if (data) in_use++;
+    return data;
+  }
+
+  void give(uchar * data)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    free.push_back(data);
+    in_use--;
+  }
+};
+
+// cv::Mat引用计数归零时由OpenCV调用deallocate，把缓冲区还给所属的Region
+// UMatData::userdata持有Region的shared_ptr，FramePool先于帧析构时内存也不会提前释放
+class PoolAllocator : public cv::MatAllocator
+{
+public:
+  // 对池内的帧重新create时退回OpenCV默认的分配方式
+  cv::UMatData * allocate(
+    int dims, const int * sizes, int type, void * data, size_t * step, cv::AccessFlag flags,
+    cv::UMatUsageFlags usage) const override
+  {
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+  }
+
+  bool allocate(cv::UMatData * u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override
+  {
+    return cv::Mat::getStdAllocator()->allocate(u, flags, usage);
+  }
+
+  void deallocate(cv::UMatData * u) const override
+  {
+    if (!u) return;
+
+    auto * region = static_cast<std::shared_ptr<FramePool::Region> *>(u->userdata);
+    (*region)->give(u->origdata);
+    delete region;
+    delete u;
+  }
+};
+
+namespace
+{
+// 与OpenCV内置的分配器相同，进程结束前不析构，保证静态对象析构时仍可释放帧
+const PoolAllocator * pool_allocator()
+{
+  static auto * allocator = new PoolAllocator();
+  return allocator;
+}
+}  // namespace
+
+FramePool::FramePool(std::size_t size, bool hugepage) : size_(size), hugepage_(hugepage) {}
+
+cv::Mat FramePool::acquire(int rows, int cols, int type)
+{
+  acquired_++;
+
+  auto bytes = static_cast<std::size_t>(rows) * cols * CV_ELEM_SIZE(type);
+  std::shared_ptr<Region> region;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!region_ || region_->bytes != bytes)
+      region_ = std::make_shared<Region>(size_, bytes, hugepage_);
+    region = region_;
+  }
+
+  bool reused;
+  auto data = region->take(reused);
+  if (!data) {
+    exhausted_++;
+    return cv::Mat(rows, cols, type);
+  }
+  if (reused) reused_++;
+
+  // 以外部数据构造后挂上自己的UMatData，此后的拷贝、ROI与普通Mat一样共享引用计数
+  cv::Mat img(rows, cols, type, data);
+  auto * u = new cv::UMatData(pool_allocator());
+  u->data = u->origdata = data;
+  u->size = bytes;
+  u->userdata = new std::shared_ptr<Region>(region);
+  u->refcount = 1;
+  img.u = u;
+  return img;
+}
+
+FramePool::Stats FramePool::stats() const
+{
+  std::size_t in_use = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (region_) in_use = region_->in_use;
+  }
+  return {acquired_, reused_, exhausted_, in_use};
+}
+
+}  // namespace tools
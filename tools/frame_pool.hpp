@@ -0,0 +1,52 @@
+#ifndef TOOLS__FRAME_POOL_HPP
+#define TOOLS__FRAME_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+namespace tools
+{
+class PoolAllocator;
+
+// 固定数量的预分配图像缓冲区，供相机采集线程逐帧复用
+// acquire()返回的cv::Mat与普通Mat一样按引用计数共享，可以直接交给检测、录像、调试等线程，
+// 最后一个引用释放时缓冲区自动回到池中；池耗尽时临时从堆上分配，不阻塞采集
+class FramePool
+{
+public:
+  struct Stats
+  {
+    std::size_t acquired;   // 取出的总帧数
+    std::size_t reused;     // 其中复用已归还缓冲区的帧数
+    std::size_t exhausted;  // 池耗尽、临时从堆上分配的帧数
+    std::size_t in_use;     // 当前仍被引用的池内缓冲区数
+  };
+
+  // hugepage为true时优先使用2MB大页，系统未预留大页时退回透明大页
+  explicit FramePool(std::size_t size, bool hugepage = false);
+
+  // 首次取出或尺寸变化时按rows x cols x type一次性分配整个池
+  // 尺寸变化前取出的帧仍然有效，释放后随旧的池一起回收
+  cv::Mat acquire(int rows, int cols, int type);
+
+  Stats stats() const;
+
+private:
+  friend class PoolAllocator;
+  struct Region;
+
+  std::size_t size_;
+  bool hugepage_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<Region> region_;
+
+  std::atomic<std::size_t> acquired_{0}, reused_{0}, exhausted_{0};
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__FRAME_POOL_HPP
@@ -0,0 +1,95 @@
+#ifndef TOOLS__MPMC_QUEUE_HPP
+#define TOOLS__MPMC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace tools
+{
+// 有界无锁多生产者多消费者队列，参考Dmitry Vyukov的bounded MPMC queue
+// 满时try_push返回false，空时try_pop返回false，均不阻塞
+template <typename T>
+class MPMCQueue
+{
+public:
+  explicit MPMCQueue(std::size_t capacity)
+  {
+    // 容量向上取整为2的幂，用掩码代替取模
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    mask_ = size - 1;
+    buffer_ = std::make_unique<Cell[]>(size);
+    for (std::size_t i = 0; i < size; i++) buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.store(0, std::memory_order_relaxed);
+  }
+
+  MPMCQueue(const MPMCQueue &) = delete;
+  MPMCQueue & operator=(const MPMCQueue &) = delete;
+
+  bool try_push(const T & value)
+  {
+    Cell * cell;
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & mask_];
+      auto sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;  // 队列已满
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T & value)
+  {
+    Cell * cell;
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & mask_];
+      auto sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;  // 队列为空
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->data);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+private:
+  struct Cell
+  {
+    std::atomic<std::size_t> sequence;
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> buffer_;
+  std::size_t mask_;
+
+  // 生产者与消费者位置分处不同缓存行，避免伪共享
+  alignas(64) std::atomic<std::size_t> enqueue_pos_;
+  alignas(64) std::atomic<std::size_t> dequeue_pos_;
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__MPMC_QUEUE_HPP
@@ -0,0 +1,193 @@
+#include "pixel_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace tools
+{
+namespace
+{
+// R像素在2x2单元中的位置
+cv::Point red_offset(PixelFormat format)
+{
+  switch (format) {
+    case PixelFormat::bayer_rg:
+      return {0, 0};
+    case PixelFormat::bayer_gr:
+      return {1, 0};
+    case PixelFormat::bayer_gb:
+      return {0, 1};
+    case PixelFormat::bayer_bg:
+      return {1, 1};
+    default:
+      throw std::runtime_error("Not a bayer format!");
+  }
+}
+
+// ROI的起点为奇数时，ROI左上角的2x2单元相对原图平移了一个像素
+cv::Point red_offset(PixelFormat format, const cv::Mat & img)
+{
+  cv::Size whole;
+  cv::Point ofs;
+  img.locateROI(whole, ofs);
+
+  auto red = red_offset(format);
+  return {red.x ^ (ofs.x & 1), red.y ^ (ofs.y & 1)};
+}
+
+// OpenCV的Bayer命名以第二行的第二、三个像素为准，与传感器左上角的命名不同
+int bayer_code(const cv::Point & red, bool gray)
+{
+  if (red == cv::Point(0, 0)) return gray ? cv::COLOR_BayerBG2GRAY : cv::COLOR_BayerBG2BGR;
+  if (red == cv::Point(1, 0)) return gray ? cv::COLOR_BayerGB2GRAY : cv::COLOR_BayerGB2BGR;
+  if (red == cv::Point(0, 1)) return gray ? cv::COLOR_BayerGR2GRAY : cv::COLOR_BayerGR2BGR;
+  return gray ? cv::COLOR_BayerRG2GRAY : cv::COLOR_BayerRG2BGR;
+}
+
+constexpr int WEIGHT_BITS = 11;
+constexpr int WEIGHT_ONE = 1 << WEIGHT_BITS;
+constexpr int ROUND = 1 << (2 * WEIGHT_BITS - 1);
+
+// 目标像素在源网格上的两个插值位置与后者的定点权重，与cv::resize的INTER_LINEAR对齐方式相同
+struct Tap
+{
+  int i0, i1, w1;
+};
+
+void make_taps(int src, int dst, std::vector<Tap> & taps)
+{
+  taps.resize(dst);
+  auto ratio = static_cast<double>(src) / dst;
+  for (int i = 0; i < dst; i++) {
+    auto f = std::max((i + 0.5) * ratio - 0.5, 0.0);
+    auto i0 = static_cast<int>(f);
+    auto w1 = static_cast<int>(std::lround((f - i0) * WEIGHT_ONE));
+    if (i0 >= src - 1) {
+      i0 = src - 1;
+      w1 = 0;
+    }
+    taps[i] = {i0, std::min(i0 + 1, src - 1), w1};
+  }
+}
+
+// 合并第j行2x2单元为BGR像素
+void bin_row(const cv::Mat & raw, const cv::Point & red, int j, uchar * dst)
+{
+  const auto * red_row = raw.ptr<uchar>(2 * j + red.y);
+  const auto * blue_row = raw.ptr<uchar>(2 * j + 1 - red.y);
+  auto cells = raw.cols / 2;
+  for (int i = 0, x = 0; i < cells; i++, x += 2) {
+    dst[3 * i + 0] = blue_row[x + 1 - red.x];
+    dst[3 * i + 1] = (red_row[x + 1 - red.x] + blue_row[x + red.x] + 1) >> 1;
+    dst[3 * i + 2] = red_row[x + red.x];
+  }
+}
+}  // namespace
+
+PixelFormat pixel_format(const std::string & name)
+{
+  if (name == "bgr") return PixelFormat::bgr;
+  if (name == "rgb") return PixelFormat::rgb;
+  if (name == "bayer_rg") return PixelFormat::bayer_rg;
+  if (name == "bayer_gr") return PixelFormat::bayer_gr;
+  if (name == "bayer_gb") return PixelFormat::bayer_gb;
+  if (name == "bayer_bg") return PixelFormat::bayer_bg;
+  throw std::runtime_error("Unknown pixel format: " + name + "!");
+}
+
+PixelFormat read_pixel_format(const YAML::Node & yaml)
+{
+  if (!yaml["camera_format"].IsDefined()) return PixelFormat::bgr;
+  return pixel_format(yaml["camera_format"].as<std::string>());
+}
+
+bool is_bayer(PixelFormat format)
+{
+  return format != PixelFormat::bgr && format != PixelFormat::rgb;
+}
+
+cv::Mat to_bgr(const cv::Mat & img, PixelFormat format)
+{
+  if (format == PixelFormat::bgr || img.empty()) return img;
+
+  cv::Mat bgr;
+  to_bgr(img, format, bgr);
+  return bgr;
+}
+
+void to_bgr(const cv::Mat & img, PixelFormat format, cv::Mat & bgr)
+{
+  if (format == PixelFormat::bgr)
+    img.copyTo(bgr);
+  else if (format == PixelFormat::rgb)
+    cv::cvtColor(img, bgr, cv::COLOR_RGB2BGR);
+  else
+    cv::cvtColor(img, bgr, bayer_code(red_offset(format, img), false));
+}
+
+void to_gray(const cv::Mat & img, PixelFormat format, cv::Mat & gray)
+{
+  if (img.channels() == 1 && !is_bayer(format))
+    img.copyTo(gray);
+  else if (format == PixelFormat::bgr)
+    cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+  else if (format == PixelFormat::rgb)
+    cv::cvtColor(img, gray, cv::COLOR_RGB2GRAY);
+  else
+    cv::cvtColor(img, gray, bayer_code(red_offset(format, img), true));
+}
+
+void bayer_resize(const cv::Mat & raw, PixelFormat format, cv::Mat & dst)
+{
+  CV_Assert(raw.type() == CV_8UC1 && dst.type() == CV_8UC3);
+
+  if (dst.cols * 2 > raw.cols || dst.rows * 2 > raw.rows) {
+    cv::resize(to_bgr(raw, format), dst, dst.size());
+    return;
+  }
+
+  auto red = red_offset(format, raw);
+  auto cells = cv::Size(raw.cols / 2, raw.rows / 2);
+
+  // 每帧尺寸一般不变，插值表和行缓存按线程复用
+  thread_local std::vector<Tap> x_taps, y_taps;
+  thread_local std::vector<uchar> rows[2];
+  make_taps(cells.width, dst.cols, x_taps);
+  make_taps(cells.height, dst.rows, y_taps);
+  for (auto & row : rows) row.resize(cells.width * 3);
+
+  // 相邻目标行常用到同一行单元，缓存最近合并的两行
+  int cached[2] = {-1, -1};
+  auto get_row = [&](int j) -> const uchar * {
+    for (int k = 0; k < 2; k++)
+      if (cached[k] == j) return rows[k].data();
+
+    // 行号随目标行单调增加，替换较早的一行
+    auto k = (cached[0] == -1 || cached[0] < cached[1]) ? 0 : 1;
+    bin_row(raw, red, j, rows[k].data());
+    cached[k] = j;
+    return rows[k].data();
+  };
+
+  for (int y = 0; y < dst.rows; y++) {
+    const auto & ty = y_taps[y];
+    const auto * top = get_row(ty.i0);
+    const auto * bottom = get_row(ty.i1);
+    auto * out = dst.ptr<uchar>(y);
+
+    for (int x = 0; x < dst.cols; x++) {
+      const auto & tx = x_taps[x];
+      auto a = 3 * tx.i0, b = 3 * tx.i1;
+      for (int c = 0; c < 3; c++) {
+        auto t = top[a + c] * (WEIGHT_ONE - tx.w1) + top[b + c] * tx.w1;
+        auto s = bottom[a + c] * (WEIGHT_ONE - tx.w1) + bottom[b + c] * tx.w1;
+        auto v = t * (WEIGHT_ONE - ty.w1) + s * ty.w1;
+        out[3 * x + c] = static_cast<uchar>((v + ROUND) >> (2 * WEIGHT_BITS));
+      }
+    }
+  }
+}
+
+}  // namespace tools
@@ -0,0 +1,46 @@
+#ifndef TOOLS__PIXEL_FORMAT_HPP
+#define TOOLS__PIXEL_FORMAT_HPP
+
+#include <yaml-cpp/yaml.h>
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+namespace tools
+{
+// 相机输出图像的像素格式，Bayer按传感器左上角2x2单元命名(与相机SDK一致)
+enum class PixelFormat
+{
+  bgr,
+  rgb,
+  bayer_rg,
+  bayer_gr,
+  bayer_gb,
+  bayer_bg
+};
+
+PixelFormat pixel_format(const std::string & name);
+
+// yaml中camera_format可选，未配置时为bgr
+PixelFormat read_pixel_format(const YAML::Node & yaml);
+
+bool is_bayer(PixelFormat format);
+
+// 转换为BGR，bgr格式时不拷贝直接返回img
+// img可以是ROI视图，Bayer的相位按ROI在原图中的起点计算
+cv::Mat to_bgr(const cv::Mat & img, PixelFormat format);
+
+// 同上，结果写入bgr，尺寸一致时复用bgr的内存
+void to_bgr(const cv::Mat & img, PixelFormat format, cv::Mat & bgr);
+
+// 转换为灰度，img同样可以是ROI视图
+void to_gray(const cv::Mat & img, PixelFormat format, cv::Mat & gray);
+
+// 融合去马赛克与缩放：Bayer图像的每个2x2单元合并为一个BGR像素(G取两个像素的均值)，
+// 同时双线性缩放到dst的尺寸，不生成全分辨率的BGR图像。dst须预先分配为CV_8UC3
+// 缩小不到一半时合并会损失细节，退回全分辨率去马赛克后再缩放
+void bayer_resize(const cv::Mat & raw, PixelFormat format, cv::Mat & dst);
+
+}  // namespace tools
+
+#endif  // TOOLS__PIXEL_FORMAT_HPP
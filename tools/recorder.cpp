@@ -10,7 +10,8 @@
 
 namespace tools
 {
-Recorder::Recorder(double fps) : init_(false), fps_(fps), queue_(1), stop_thread_(false)
+Recorder::Recorder(double fps, PixelFormat format)
+: init_(false), fps_(fps), format_(format), queue_(1), stop_thread_(false)
 {
   start_time_ = std::chrono::steady_clock::now();
   last_time_ = start_time_;
@@ -45,7 +46,7 @@ void Recorder::save_to_file()
       continue;
     }
     // 写入视频文件
-    video_writer_.write(frame.img);
+    video_writer_.write(tools::to_bgr(frame.img, format_));
 
     // 写入文本文件（输出顺序为wxyz）
     Eigen::Vector4d xyzw = frame.q.coeffs();
@@ -7,13 +7,15 @@
 #include <opencv2/opencv.hpp>
 #include <thread>
 
+#include "tools/pixel_format.hpp"
 #include "tools/thread_safe_queue.hpp"
 namespace tools
 {
 class Recorder
 {
 public:
-  Recorder(double fps = 30);
+  // format为相机输出的原始格式时，在保存线程中转换为BGR后写入视频
+  Recorder(double fps = 30, PixelFormat format = PixelFormat::bgr);
   ~Recorder();
   void record(
     const cv::Mat & img, const Eigen::Quaterniond & q,
@@ -29,6 +31,7 @@ private:
   bool init_;
   std::atomic<bool> stop_thread_;
   double fps_;
+  PixelFormat format_;
   std::string text_path_;
   std::string video_path_;
   std::ofstream text_writer_;
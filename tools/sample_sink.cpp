@@ -0,0 +1,189 @@
+#include "sample_sink.hpp"
+
+#include <fmt/chrono.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#include "tools/logger.hpp"
+
+namespace tools
+{
+SampleSink::SampleSink(
+  const std::string & save_path, const std::vector<std::string> & class_names, double max_rate,
+  std::size_t max_class_bytes, std::size_t max_total_bytes, std::size_t capacity,
+  cv::Size max_size)
+: save_path_(save_path),
+  class_names_(class_names),
+  min_interval_ns_(static_cast<std::int64_t>(1e9 / max_rate)),
+  max_class_bytes_(max_class_bytes),
+  max_total_bytes_(max_total_bytes),
+  max_size_(max_size),
+  slots_(capacity),
+  free_slots_(capacity),
+  ready_slots_(capacity),
+  class_states_(std::make_unique<ClassState[]>(class_names.size()))
+{
+  std::filesystem::create_directory(save_path_);
+
+  // 统计目录中已有的样本，配额跨多次运行生效
+  for (const auto & entry : std::filesystem::directory_iterator(save_path_)) {
+    if (!entry.is_regular_file()) continue;
+
+    auto size = entry.file_size();
+    auto file_name = entry.path().filename().string();
+    total_bytes_ += size;
+    for (std::size_t i = 0; i < class_names_.size(); i++) {
+      if (file_name.rfind(class_names_[i] + "_", 0) != 0) continue;
+      class_states_[i].bytes += size;
+      break;
+    }
+  }
+
+  // 预分配全部缓冲区，运行时不再申请内存
+  for (std::size_t i = 0; i < slots_.size(); i++) {
+    slots_[i].buffer.create(max_size_, CV_8UC3);
+    free_slots_.try_push(static_cast<int>(i));
+  }
+
+  saving_thread_ = std::thread(&SampleSink::save_to_file, this);
+}
+
+SampleSink::~SampleSink()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  condition_.notify_one();
+  if (saving_thread_.joinable()) saving_thread_.join();
+
+  tools::logger()->info(
+    "[SampleSink] {} saved, dropped by rate: {}, full: {}, quota: {}, error: {}", saved_.load(),
+    dropped_rate_.load(), dropped_full_.load(), dropped_quota_.load(), dropped_error_.load());
+}
+
+bool SampleSink::push(const cv::Mat & img, int class_id)
+{
+  if (img.empty() || img.type() != CV_8UC3) return false;
+  if (class_id < 0 || class_id >= static_cast<int>(class_names_.size())) return false;
+
+  if (class_states_[class_id].bytes >= max_class_bytes_ || total_bytes_ >= max_total_bytes_) {
+    dropped_quota_++;
+    return false;
+  }
+
+  if (!acquire_rate(class_id)) {
+    dropped_rate_++;
+    return false;
+  }
+
+  int index;
+  if (!free_slots_.try_pop(index)) {
+    dropped_full_++;
+    return false;
+  }
+
+  // 拷贝进缓冲区左上角，超出尺寸时等比缩小
+  auto & slot = slots_[index];
+  auto scale = std::min(
+    {1.0, static_cast<double>(max_size_.width) / img.cols,
+     static_cast<double>(max_size_.height) / img.rows});
+  slot.size = {
+    std::max(1, static_cast<int>(img.cols * scale)),
+    std::max(1, static_cast<int>(img.rows * scale))};
+  slot.class_id = class_id;
+
+  auto roi = slot.buffer(cv::Rect({0, 0}, slot.size));
+  if (scale < 1)
+    cv::resize(img, roi, slot.size);
+  else
+    img.copyTo(roi);
+
+  // 缓冲区个数不超过队列容量，不会失败
+  ready_slots_.try_push(index);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_++;
+  }
+  condition_.notify_one();
+  return true;
+}
+
+bool SampleSink::acquire_rate(int class_id)
+{
+  auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+               .count();
+
+  auto & last_ns = class_states_[class_id].last_ns;
+  auto last = last_ns.load(std::memory_order_relaxed);
+  if (last != 0 && now - last < min_interval_ns_) return false;
+
+  // 多个线程同时保存同一类时只放行一个
+  return last_ns.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+void SampleSink::save_to_file()
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return quit_ || pending_ > 0; });
+      if (pending_ == 0) break;  // 已退出且队列已清空
+      pending_--;
+    }
+
+    int index;
+    ready_slots_.try_pop(index);
+    write(slots_[index]);
+    free_slots_.try_push(index);
+  }
+}
+
+void SampleSink::write(const Slot & slot)
+{
+  std::vector<uchar> jpg;
+  if (!cv::imencode(".jpg", slot.buffer(cv::Rect({0, 0}, slot.size)), jpg)) {
+    dropped_error_++;
+    return;
+  }
+
+  auto & state = class_states_[slot.class_id];
+  if (state.bytes + jpg.size() > max_class_bytes_ || total_bytes_ + jpg.size() > max_total_bytes_) {
+    dropped_quota_++;
+    return;
+  }
+
+  auto file_name = fmt::format("{:%Y-%m-%d_%H-%M-%S}", std::chrono::system_clock::now());
+  auto img_path = fmt::format(
+    "{}/{}_{}_{}.jpg", save_path_, class_names_[slot.class_id], file_name, saved_.load());
+
+  std::ofstream file(img_path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(jpg.data()), jpg.size());
+  if (!file) {
+    tools::logger()->warn("[SampleSink] Failed to write {}", img_path);
+    dropped_error_++;
+    return;
+  }
+
+  state.bytes += jpg.size();
+  total_bytes_ += jpg.size();
+  saved_++;
+}
+
+SampleSink & sample_sink(
+  const std::string & save_path, const std::vector<std::string> & class_names)
+{
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::unique_ptr<SampleSink>> sinks;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto & sink = sinks[save_path];
+  if (!sink) sink = std::make_unique<SampleSink>(save_path, class_names);
+  return *sink;
+}
+
+}  // namespace tools
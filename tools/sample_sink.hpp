@@ -0,0 +1,97 @@
+#ifndef TOOLS__SAMPLE_SINK_HPP
+#define TOOLS__SAMPLE_SINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tools/mpmc_queue.hpp"
+
+namespace tools
+{
+// 异步保存图案样本，用于分类器的迭代
+// 检测线程只需把图案拷贝进预分配的缓冲区，jpg编码与写盘在后台线程完成
+// 配额按目录统计，同一目录应共用一个实例，通过tools::sample_sink()获取
+class SampleSink
+{
+public:
+  SampleSink(
+    const std::string & save_path, const std::vector<std::string> & class_names,
+    double max_rate = 2.0,                            // 每类每秒最多保存张数
+    std::size_t max_class_bytes = 64 * 1024 * 1024,   // 每类磁盘配额
+    std::size_t max_total_bytes = 512 * 1024 * 1024,  // 总磁盘配额
+    std::size_t capacity = 32,                        // 缓冲区个数
+    cv::Size max_size = {256, 256});                  // 超出尺寸的图案等比缩小
+
+  // 写完已入队的样本后退出
+  ~SampleSink();
+
+  SampleSink(const SampleSink &) = delete;
+  SampleSink & operator=(const SampleSink &) = delete;
+
+  // 非阻塞，仅支持CV_8UC3，返回false表示样本被丢弃
+  bool push(const cv::Mat & img, int class_id);
+
+  std::uint64_t saved() const { return saved_; }
+  std::uint64_t dropped() const
+  {
+    return dropped_rate_ + dropped_full_ + dropped_quota_ + dropped_error_;
+  }
+
+private:
+  struct Slot
+  {
+    cv::Mat buffer;  // max_size大小，样本写入其左上角
+    cv::Size size;
+    int class_id;
+  };
+
+  struct ClassState
+  {
+    std::atomic<std::int64_t> last_ns{0};
+    std::atomic<std::size_t> bytes{0};
+  };
+
+  std::string save_path_;
+  std::vector<std::string> class_names_;
+  std::int64_t min_interval_ns_;
+  std::size_t max_class_bytes_, max_total_bytes_;
+  cv::Size max_size_;
+
+  std::vector<Slot> slots_;
+  MPMCQueue<int> free_slots_;
+  MPMCQueue<int> ready_slots_;
+  std::unique_ptr<ClassState[]> class_states_;
+
+  std::atomic<std::size_t> total_bytes_{0};
+  std::atomic<std::uint64_t> saved_{0};
+  std::atomic<std::uint64_t> dropped_rate_{0};
+  std::atomic<std::uint64_t> dropped_full_{0};
+  std::atomic<std::uint64_t> dropped_quota_{0};
+  std::atomic<std::uint64_t> dropped_error_{0};
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::size_t pending_ = 0;  // ready_slots_中待写的样本数，由mutex_保护
+  bool quit_ = false;        // 由mutex_保护
+  std::thread saving_thread_;
+
+  bool acquire_rate(int class_id);
+  void save_to_file();
+  void write(const Slot & slot);
+};
+
+// 按save_path共用的SampleSink，第一次调用时创建，之后的class_names被忽略
+SampleSink & sample_sink(
+  const std::string & save_path, const std::vector<std::string> & class_names);
+
+}  // namespace tools
+
+#endif  // TOOLS__SAMPLE_SINK_HPP